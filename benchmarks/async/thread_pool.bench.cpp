@@ -0,0 +1,133 @@
+/*
+ * Tags: async, thread_pool, benchmark
+ *
+ * Measures coroutine resume throughput of lcl::async::thread_pool against the previous single-lock pool at 1-64
+ * threads. Each run starts a number of independent coroutine chains that repeatedly reschedule themselves onto the
+ * pool, which is the same shape as a continuation being resumed by a resolved DeferredTask.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <latch>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "async/thread_pool.hpp"
+
+namespace {
+  // The pool task.hpp used before the work-stealing scheduler; kept here as the baseline
+  class locked_thread_pool {
+    std::vector<std::thread> workers_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex queue_mutex_;
+    std::condition_variable condition_;
+    bool stop_ = false;
+
+  public:
+    explicit locked_thread_pool(const size_t num_threads) {
+      for (size_t i = 0; i < num_threads; ++i) {
+        workers_.emplace_back([this] {
+          while (true) {
+            std::function<void()> task;
+            {
+              std::unique_lock lock(queue_mutex_);
+              condition_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+              if (stop_ && tasks_.empty()) return;
+              task = std::move(tasks_.front());
+              tasks_.pop();
+            }
+            task();
+          }
+        });
+      }
+    }
+
+    ~locked_thread_pool() {
+      {
+        std::unique_lock lock(queue_mutex_);
+        stop_ = true;
+      }
+      condition_.notify_all();
+      for (auto& worker : workers_) {
+        worker.join();
+      }
+    }
+
+    void enqueue(std::function<void()> func) {
+      {
+        std::unique_lock lock(queue_mutex_);
+        tasks_.push(std::move(func));
+      }
+      condition_.notify_one();
+    }
+
+    auto schedule() {
+      struct awaiter {
+        locked_thread_pool& pool;
+
+        [[nodiscard]] bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) const {
+          pool.enqueue([handle] { handle.resume(); });
+        }
+        void await_resume() const noexcept {}
+      };
+      return awaiter { *this };
+    }
+  };
+
+  // Fire-and-forget coroutine; the frame frees itself when the chain finishes
+  struct detached {
+    struct promise_type {
+      detached get_return_object() noexcept { return {}; }
+      std::suspend_never initial_suspend() noexcept { return {}; }
+      std::suspend_never final_suspend() noexcept { return {}; }
+      void return_void() noexcept {}
+      void unhandled_exception() { std::terminate(); }
+    };
+  };
+
+  template<typename Pool>
+  detached chain(Pool& pool, const int hops, std::latch& done) {
+    for (int i = 0; i < hops; ++i) {
+      co_await pool.schedule();
+    }
+    done.count_down();
+  }
+
+  template<typename Pool>
+  double resumes_per_second(const size_t threads, const int chains, const int hops) {
+    Pool pool(threads);
+    std::latch done(chains);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < chains; ++i) {
+      chain(pool, hops, done);
+    }
+    done.wait();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    return static_cast<double>(chains) * hops / elapsed.count();
+  }
+}
+
+int main(const int argc, char** argv) {
+  const int chains = argc > 1 ? std::atoi(argv[1]) : 256;
+  const int hops = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+  std::printf("%d chains x %d hops\n", chains, hops);
+  std::printf("%8s %18s %20s %8s\n", "threads", "locked (resume/s)", "stealing (resume/s)", "speedup");
+  for (const size_t threads : { 1, 2, 4, 8, 16, 32, 64 }) {
+    const auto locked = resumes_per_second<locked_thread_pool>(threads, chains, hops);
+    const auto stealing = resumes_per_second<lcl::async::thread_pool>(threads, chains, hops);
+    std::printf("%8zu %18.0f %20.0f %7.2fx\n", threads, locked, stealing, stealing / locked);
+  }
+
+  return 0;
+}
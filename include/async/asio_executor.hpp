@@ -0,0 +1,61 @@
+/*
+ * Tags: async, executor, asio, coroutine, c++23
+ */
+
+#pragma once
+#include <coroutine>
+#include <utility>
+
+#include "asio/io_context.hpp"
+#include "asio/post.hpp"
+#include "asio/strand.hpp"
+#include "executor.hpp"
+#include "work_item.hpp"
+
+namespace lcl::async {
+  // Resumes coroutines on an asio executor, so code driven by an io_context (reading a transport, decoding frames,
+  // completing the requests waiting on them) resumes its awaiters on the thread that produced the result instead of
+  // hopping through the thread pool. Work submitted from a thread already running the executor runs inline; anything
+  // else is posted. Wrap a strand to get the same guarantees on an io_context run by several threads.
+  template<typename Executor>
+  class asio_executor final : public executor {
+    Executor executor_;
+
+  public:
+    explicit asio_executor(Executor executor) : executor_(std::move(executor)) {}
+
+    asio_executor(const asio_executor&) = delete;
+    asio_executor& operator=(const asio_executor&) = delete;
+
+    void execute(work_item item) override {
+      if (executor_.running_in_this_thread()) {
+        item();
+        return;
+      }
+      asio::post(executor_, [item = std::move(item)]() mutable {
+        item();
+      });
+    }
+
+    // Awaitable that resumes the awaiting coroutine on this executor; always goes through the queue
+    auto schedule() {
+      struct awaiter {
+        const Executor& executor;
+
+        [[nodiscard]] bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) const {
+          asio::post(executor, handle);
+        }
+        void await_resume() const noexcept {}
+      };
+      return awaiter { executor_ };
+    }
+
+    [[nodiscard]] const Executor& get_inner_executor() const noexcept {
+      return executor_;
+    }
+  };
+
+  using io_context_executor = asio_executor<asio::io_context::executor_type>;
+  using io_context_strand_executor = asio_executor<asio::strand<asio::io_context::executor_type>>;
+}
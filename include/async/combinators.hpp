@@ -0,0 +1,183 @@
+/*
+ * Tags: async, coroutine, c++23
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <ranges>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "task.hpp"
+
+namespace lcl::async {
+  // Tasks start eagerly, so by the time they reach a combinator they're already running concurrently; the combinators
+  // only decide how their completions are collected. Exceptions are rethrown from the combinator once it gets to the
+  // failing task; any tasks still running at that point are detached and finish on their own.
+
+  // Awaits every task, returning their results in argument order
+  template<typename... T>
+  Task<std::tuple<T...>> when_all(Task<T>... tasks) {
+    // Braced initialization evaluates left to right, so each task is awaited in order
+    co_return std::tuple<T...> { co_await tasks... };
+  }
+
+  // Awaits every task, returning their results in the order the tasks were given
+  template<typename T>
+  Task<std::vector<T>> when_all(std::vector<Task<T>> tasks) {
+    std::vector<T> results;
+    results.reserve(tasks.size());
+    for (auto& task : tasks) {
+      results.push_back(co_await task);
+    }
+    co_return results;
+  }
+
+  inline Task<void> when_all(std::vector<Task<void>> tasks) {
+    for (auto& task : tasks) {
+      co_await task;
+    }
+  }
+
+  template<typename T>
+  struct when_any_result {
+    // Position of the first task to complete
+    std::size_t index;
+    T value;
+  };
+
+  namespace detail {
+    template<typename T>
+    Task<void> complete_first(Task<T> task, const std::size_t index, typename DeferredTask<when_any_result<T>>::resolver first) {
+      try {
+        // Resolvers ignore everything after the first resolution, so the losers' results are simply dropped
+        first.resolve({ index, co_await task });
+      } catch (...) {
+        first.reject(std::current_exception());
+      }
+    }
+
+    inline Task<void> complete_first(Task<void> task, const std::size_t index, DeferredTask<std::size_t>::resolver first) {
+      try {
+        co_await task;
+        first.resolve(index);
+      } catch (...) {
+        first.reject(std::current_exception());
+      }
+    }
+  }
+
+  // Awaits whichever task completes first, whether with a value or an exception. The remaining tasks keep running
+  // detached and their results are discarded.
+  template<typename T>
+  Task<when_any_result<T>> when_any(std::vector<Task<T>> tasks) {
+    if (tasks.empty()) {
+      throw std::invalid_argument("when_any requires at least one task");
+    }
+
+    DeferredTask<when_any_result<T>> first;
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+      detail::complete_first(std::move(tasks[i]), i, first.get_resolver()).detach();
+    }
+    co_return co_await first;
+  }
+
+  // Returns the index of the first task to complete
+  inline Task<std::size_t> when_any(std::vector<Task<void>> tasks) {
+    if (tasks.empty()) {
+      throw std::invalid_argument("when_any requires at least one task");
+    }
+
+    DeferredTask<std::size_t> first;
+    for (std::size_t i = 0; i < tasks.size(); ++i) {
+      detail::complete_first(std::move(tasks[i]), i, first.get_resolver()).detach();
+    }
+    co_return co_await first;
+  }
+
+  namespace detail {
+    template<typename T>
+    struct task_value;
+
+    template<typename T>
+    struct task_value<Task<T>> {
+      using type = T;
+    };
+
+    // Unlike when_all this waits for every worker even after one fails, since they all borrow the caller's frame
+    inline Task<void> join_workers(std::vector<Task<void>> workers) {
+      std::exception_ptr failure;
+      for (auto& worker : workers) {
+        try {
+          co_await worker;
+        } catch (...) {
+          if (!failure) failure = std::current_exception();
+        }
+      }
+      if (failure) std::rethrow_exception(failure);
+    }
+  }
+
+  // Runs fn over every item with at most max_concurrency of the returned tasks in flight at once, returning the results
+  // in item order. The items must outlive the returned task.
+  template<std::ranges::random_access_range Range, typename F>
+    requires (!std::is_void_v<typename detail::task_value<std::invoke_result_t<F&, std::ranges::range_reference_t<Range>>>::type>)
+  auto for_each_async(Range& items, const std::size_t max_concurrency, F fn)
+    -> Task<std::vector<typename detail::task_value<std::invoke_result_t<F&, std::ranges::range_reference_t<Range>>>::type>> {
+    using result_type = typename detail::task_value<std::invoke_result_t<F&, std::ranges::range_reference_t<Range>>>::type;
+
+    const auto count = static_cast<std::size_t>(std::ranges::size(items));
+    std::vector<std::optional<result_type>> slots(count);
+    std::atomic<std::size_t> next{0};
+
+    // Each worker pulls the next unclaimed item as soon as its previous one finishes
+    auto worker = [&]() -> Task<void> {
+      for (auto i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+        slots[i] = co_await fn(std::ranges::begin(items)[i]);
+      }
+    };
+
+    std::vector<Task<void>> workers;
+    const auto worker_count = std::min(std::max<std::size_t>(max_concurrency, 1), count);
+    workers.reserve(worker_count);
+    for (std::size_t i = 0; i < worker_count; ++i) {
+      workers.push_back(worker());
+    }
+    co_await detail::join_workers(std::move(workers));
+
+    std::vector<result_type> results;
+    results.reserve(count);
+    for (auto& slot : slots) {
+      results.push_back(std::move(*slot));
+    }
+    co_return results;
+  }
+
+  template<std::ranges::random_access_range Range, typename F>
+    requires std::is_void_v<typename detail::task_value<std::invoke_result_t<F&, std::ranges::range_reference_t<Range>>>::type>
+  Task<void> for_each_async(Range& items, const std::size_t max_concurrency, F fn) {
+    const auto count = static_cast<std::size_t>(std::ranges::size(items));
+    std::atomic<std::size_t> next{0};
+
+    auto worker = [&]() -> Task<void> {
+      for (auto i = next.fetch_add(1); i < count; i = next.fetch_add(1)) {
+        co_await fn(std::ranges::begin(items)[i]);
+      }
+    };
+
+    std::vector<Task<void>> workers;
+    const auto worker_count = std::min(std::max<std::size_t>(max_concurrency, 1), count);
+    workers.reserve(worker_count);
+    for (std::size_t i = 0; i < worker_count; ++i) {
+      workers.push_back(worker());
+    }
+    co_await detail::join_workers(std::move(workers));
+  }
+}
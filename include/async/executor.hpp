@@ -0,0 +1,18 @@
+/*
+ * Tags: async, executor, c++23
+ */
+
+#pragma once
+#include "work_item.hpp"
+
+namespace lcl::async {
+  // Where a suspended coroutine is resumed once whatever it awaited completes. thread_pool always queues the work;
+  // asio_executor runs it inline when submitted from one of its own threads so a completion and its awaiter share a
+  // thread.
+  class executor {
+  public:
+    virtual ~executor() = default;
+
+    virtual void execute(work_item item) = 0;
+  };
+}
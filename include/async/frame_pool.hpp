@@ -0,0 +1,148 @@
+/*
+ * Tags: async, coroutine, allocator, c++23
+ */
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <new>
+#include <utility>
+
+namespace lcl::async {
+  // Thread-local, size-bucketed free lists for coroutine frames. Frames are rounded up to a power of two between
+  // min_block and max_block; larger frames go straight to the global heap. A frame freed on a different thread than
+  // the one that allocated it simply joins the freeing thread's cache, and each bucket caches at most
+  // max_cached_blocks so a thread that only ever frees can't hoard memory.
+  class frame_pool {
+  public:
+    static constexpr std::size_t min_block = 64;
+    static constexpr std::size_t max_block = 4096;
+    static constexpr std::size_t max_cached_blocks = 64;
+
+    // Counters for the calling thread
+    struct statistics {
+      std::uint64_t allocations = 0;
+      std::uint64_t pool_hits = 0;
+      std::uint64_t heap_allocations = 0;
+      std::uint64_t oversized_allocations = 0;
+      std::uint64_t deallocations = 0;
+      std::uint64_t cached_blocks = 0;
+    };
+
+    static void* allocate(const std::size_t size) {
+      auto& pool = local();
+      pool.stats_.allocations++;
+      if (size > max_block) {
+        pool.stats_.oversized_allocations++;
+        return ::operator new(size);
+      }
+
+      const auto index = bucket_index(size);
+      if (auto* block = pool.buckets_[index].head) {
+        pool.buckets_[index].head = block->next;
+        pool.buckets_[index].count--;
+        pool.stats_.pool_hits++;
+        pool.stats_.cached_blocks--;
+        return block;
+      }
+      pool.stats_.heap_allocations++;
+      return ::operator new(bucket_size(index));
+    }
+
+    static void deallocate(void* pointer, const std::size_t size) noexcept {
+      auto& pool = local();
+      pool.stats_.deallocations++;
+      if (size > max_block) {
+        ::operator delete(pointer);
+        return;
+      }
+
+      const auto index = bucket_index(size);
+      auto& bucket = pool.buckets_[index];
+      if (bucket.count >= max_cached_blocks) {
+        ::operator delete(pointer);
+        return;
+      }
+      bucket.head = ::new (pointer) free_block { bucket.head };
+      bucket.count++;
+      pool.stats_.cached_blocks++;
+    }
+
+    [[nodiscard]] static statistics local_statistics() {
+      return local().stats_;
+    }
+
+    frame_pool(const frame_pool&) = delete;
+    frame_pool& operator=(const frame_pool&) = delete;
+
+  private:
+    struct free_block {
+      free_block* next;
+    };
+
+    struct bucket {
+      free_block* head = nullptr;
+      std::size_t count = 0;
+    };
+
+    static constexpr std::size_t bucket_count = std::countr_zero(max_block) - std::countr_zero(min_block) + 1;
+
+    std::array<bucket, bucket_count> buckets_ {};
+    statistics stats_;
+
+    frame_pool() = default;
+
+    ~frame_pool() {
+      for (auto& bucket : buckets_) {
+        while (bucket.head) {
+          ::operator delete(std::exchange(bucket.head, bucket.head->next));
+        }
+      }
+    }
+
+    static frame_pool& local() {
+      static thread_local frame_pool pool;
+      return pool;
+    }
+
+    static constexpr std::size_t bucket_index(const std::size_t size) {
+      return std::countr_zero(std::bit_ceil(std::max(size, min_block))) - std::countr_zero(min_block);
+    }
+
+    static constexpr std::size_t bucket_size(const std::size_t index) {
+      return min_block << index;
+    }
+  };
+
+  // Mixed into promise types so their coroutine frames come from the frame_pool
+  struct pooled_frame {
+    static void* operator new(const std::size_t size) {
+      void* frame = frame_pool::allocate(size);
+#ifndef NDEBUG
+      live_frames_.fetch_add(1, std::memory_order_relaxed);
+#endif
+      return frame;
+    }
+
+    static void operator delete(void* pointer, const std::size_t size) noexcept {
+#ifndef NDEBUG
+      live_frames_.fetch_sub(1, std::memory_order_relaxed);
+#endif
+      frame_pool::deallocate(pointer, size);
+    }
+
+#ifndef NDEBUG
+    // Frames allocated and not yet destroyed, across all threads; debug builds only, for catching leaked tasks
+    [[nodiscard]] static std::int64_t live_frames() {
+      return live_frames_.load(std::memory_order_relaxed);
+    }
+
+  private:
+    static inline std::atomic<std::int64_t> live_frames_{0};
+#endif
+  };
+}
@@ -0,0 +1,104 @@
+/*
+ * Tags: async, caching, c++23
+ */
+
+#pragma once
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "task.hpp"
+
+namespace lcl::async {
+  // Shares one run of a query between concurrent callers and reuses its result for a while afterwards. Callers arriving
+  // while a run is in flight wait for it instead of starting their own; results the cacheable predicate accepts are
+  // then handed out until they're older than the ttl passed to run. Runs are tracked per generation, so callers
+  // arriving after invalidate never join a run that started before it.
+  template<typename T>
+  class single_flight {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    explicit single_flight(std::function<bool(const T&)> cacheable = [](const T&) { return true; },
+                           executor& resume_on = get_thread_pool())
+      : cacheable_(std::move(cacheable)), resume_on_(resume_on) {}
+
+    single_flight(const single_flight&) = delete;
+    single_flight& operator=(const single_flight&) = delete;
+
+    // Returns a result younger than ttl, joins the run in flight, or starts fn. A zero ttl only shares runs in flight;
+    // clock::duration::max() keeps a result until invalidate.
+    template<typename F>
+    Task<T> run(F fn, const clock::duration ttl) {
+      std::optional<DeferredTask<T>> in_flight;
+      std::optional<T> fresh;
+      uint64_t generation;
+      {
+        std::lock_guard lock(mutex_);
+        if (cached_.has_value() && clock::now() - cached_->second <= ttl) {
+          fresh = cached_->first;
+        } else if (const auto running = runs_.find(generation_); running != runs_.end()) {
+          in_flight.emplace(resume_on_);
+          running->second.push_back(in_flight->get_resolver());
+        } else {
+          runs_.emplace(generation_, std::vector<typename DeferredTask<T>::resolver> {});
+        }
+        generation = generation_;
+      }
+
+      if (fresh.has_value()) {
+        co_return std::move(*fresh);
+      }
+      if (in_flight.has_value()) {
+        co_return co_await *in_flight;
+      }
+
+      try {
+        T result = co_await fn();
+        for (const auto& waiter : finish(generation, &result)) {
+          waiter.resolve(result);
+        }
+        co_return result;
+      } catch (...) {
+        const auto failure = std::current_exception();
+        for (const auto& waiter : finish(generation, nullptr)) {
+          waiter.reject(failure);
+        }
+        throw;
+      }
+    }
+
+    // Drops the cached result; a run in flight when this is called won't be cached either, and later callers start a
+    // new run rather than joining it
+    void invalidate() {
+      std::lock_guard lock(mutex_);
+      cached_.reset();
+      generation_++;
+    }
+
+  private:
+    std::vector<typename DeferredTask<T>::resolver> finish(const uint64_t generation, const T* result) {
+      std::lock_guard lock(mutex_);
+      if (result != nullptr && generation == generation_ && cacheable_(*result)) {
+        cached_.emplace(*result, clock::now());
+      }
+      const auto run = runs_.find(generation);
+      auto waiters = std::move(run->second);
+      runs_.erase(run);
+      return waiters;
+    }
+
+    std::function<bool(const T&)> cacheable_;
+    executor& resume_on_;
+    std::mutex mutex_;
+    std::optional<std::pair<T, clock::time_point>> cached_;
+    uint64_t generation_ = 0;
+    // The callers waiting on each run in flight, keyed by the generation it started in
+    std::map<uint64_t, std::vector<typename DeferredTask<T>::resolver>> runs_;
+  };
+}
@@ -12,84 +12,161 @@
 #include <condition_variable>
 #include <vector>
 #include <atomic>
+#include <cstdint>
 #include <optional>
 #include <memory>
+#include <semaphore>
+#include <stdexcept>
+#include <stop_token>
+#include <utility>
+
+#include "executor.hpp"
+#include "frame_pool.hpp"
+#include "thread_pool.hpp"
 
 namespace lcl::async {
-  // Simple thread pool implementation
-  class thread_pool {
-    std::queue<std::function<void()>> tasks_;
-    std::mutex mutex_;
-    std::condition_variable cv_;
-    std::vector<std::thread> workers_;
-    std::atomic<bool> stop_{false};
+  // Thrown into an awaiter whose operation was cancelled before it produced a result
+  class cancelled_error : public std::runtime_error {
+  public:
+    using std::runtime_error::runtime_error;
+  };
 
+  // Thrown into an awaiter whose operation didn't finish before its deadline
+  class timeout_error : public cancelled_error {
   public:
-    explicit thread_pool(const size_t num_threads = std::thread::hardware_concurrency()) {
-      for (size_t i = 0; i < num_threads; ++i) {
-        workers_.emplace_back([this] {
-          while (true) {
-            std::function<void()> task;
-            {
-              std::unique_lock<std::mutex> lock(mutex_);
-              cv_.wait(lock, [this] { return !tasks_.empty() || stop_.load(); });
-              if (stop_.load() && tasks_.empty()) {
-                return;
-              }
-              task = std::move(tasks_.front());
-              tasks_.pop();
-            }
-            task();
-          }
-        });
+    using cancelled_error::cancelled_error;
+  };
+
+  // Lifecycle of an eager Task's frame. The coroutine finishing, an awaiter registering its continuation and the owning
+  // Task letting go of the frame can happen on different threads; whoever moves the state second acts on it.
+  enum class task_state : uint8_t {
+    running,
+    awaited,
+    completed,
+    detached
+  };
+
+  // State shared by every Task promise
+  struct task_promise_base : pooled_frame {
+    std::exception_ptr exception_;
+    std::coroutine_handle<> continuation_;
+    std::atomic<task_state> state_{task_state::running};
+
+    void unhandled_exception() { exception_ = std::current_exception(); }
+  };
+
+  // Final awaiter for Task; resumes whoever is awaiting the task once it completes
+  struct final_awaiter {
+    [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+    template<typename TPromise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<TPromise> handle) const noexcept {
+      auto& promise = handle.promise();
+      switch (promise.state_.exchange(task_state::completed, std::memory_order_acq_rel)) {
+        case task_state::awaited:
+          // The awaiter is already suspended so transfer to it directly instead of hopping through the pool
+          return promise.continuation_;
+        case task_state::detached:
+          // Nobody owns the frame anymore
+          handle.destroy();
+          break;
+        default:
+          break;
       }
+      return std::noop_coroutine();
     }
 
-    ~thread_pool() {
-      stop_.store(true);
-      cv_.notify_all();
-      for (auto& worker : workers_) {
-        worker.join();
-      }
+    void await_resume() const noexcept {}
+  };
+
+  // Releases a Task's frame: destroyed now if the coroutine has finished, otherwise by final_awaiter once it does
+  template<typename TPromise>
+  void release_task_frame(const std::coroutine_handle<TPromise> handle) noexcept {
+    if (handle.promise().state_.exchange(task_state::detached, std::memory_order_acq_rel) == task_state::completed) {
+      handle.destroy();
     }
+  }
 
-    void enqueue(std::function<void()> func) {
-      {
-        std::unique_lock lock(mutex_);
-        if (stop_.load()) {
-          throw std::runtime_error("Cannot enqueue on stopped thread pool");
-        }
-        tasks_.emplace(std::move(func));
+  // State shared by every LazyTask promise. The awaiter resumes the body itself; whichever of the body finishing and
+  // the awaiter seeing it suspend happens second sets handed_off_ and is the one that carries on with the awaiter.
+  struct lazy_promise_base : pooled_frame {
+    std::exception_ptr exception_;
+    std::coroutine_handle<> continuation_;
+    std::atomic<bool> handed_off_{false};
+
+    void unhandled_exception() { exception_ = std::current_exception(); }
+  };
+
+  // Final awaiter for LazyTask; only resumes the awaiter if the body suspended before finishing, since a body that
+  // finished synchronously returns to the awaiter's await_suspend instead
+  struct lazy_final_awaiter {
+    [[nodiscard]] bool await_ready() const noexcept { return false; }
+
+    template<typename TPromise>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<TPromise> handle) const noexcept {
+      auto& promise = handle.promise();
+      if (promise.handed_off_.exchange(true, std::memory_order_acq_rel)) {
+        return promise.continuation_;
       }
-      cv_.notify_one();
+      return std::noop_coroutine();
     }
+
+    void await_resume() const noexcept {}
   };
 
-  // Global thread pool accessor
-  inline thread_pool& get_thread_pool() {
-    static thread_pool pool{};
-    return pool;
+  // Runs a lazy task's body on behalf of {@param awaiter}. Returns false, so the awaiter carries on without suspending,
+  // when the body finished synchronously; the stack is unwound before the awaiter continues whether or not the compiler
+  // turns symmetric transfer into a tail call, so long runs of synchronous completions can't overflow it.
+  template<typename TPromise>
+  bool start_lazy_task(const std::coroutine_handle<TPromise> handle, const std::coroutine_handle<> awaiter) noexcept {
+    handle.promise().continuation_ = awaiter;
+    handle.resume();
+    return !handle.promise().handed_off_.exchange(true, std::memory_order_acq_rel);
   }
 
-  // A task type for async operations
+  // A task type for async operations. Tasks start eagerly and own their frame; dropping a Task that's still running
+  // detaches it, and the frame is destroyed when the coroutine finishes.
   template<typename T>
   struct Task {
-    struct promise_type {
+    struct promise_type : task_promise_base {
       std::optional<T> value_;
-      std::exception_ptr exception_;
 
-      Task get_return_object() { return {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+      Task get_return_object() { return Task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
       std::suspend_never initial_suspend() { return {}; }
-      std::suspend_always final_suspend() noexcept { return {}; }
-      void return_value(T value) { value_ = value; }
-      void unhandled_exception() { exception_ = std::current_exception(); }
+      final_awaiter final_suspend() noexcept { return {}; }
+      void return_value(T value) { value_ = std::move(value); }
     };
 
-    bool await_ready() { return handle_.done(); }
-    void await_suspend(std::coroutine_handle<> handle) {
-      get_thread_pool().enqueue([handle]() mutable {
-        handle.resume();
-      });
+    explicit Task(const std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    Task& operator=(Task&& other) noexcept {
+      if (this != &other) {
+        detach();
+        handle_ = std::exchange(other.handle_, {});
+      }
+      return *this;
+    }
+
+    ~Task() {
+      detach();
+    }
+
+    // Gives up the task for fire-and-forget use; it keeps running and cleans up after itself
+    void detach() noexcept {
+      if (handle_) release_task_frame(std::exchange(handle_, {}));
+    }
+
+    bool await_ready() const {
+      return handle_.promise().state_.load(std::memory_order_acquire) == task_state::completed;
+    }
+    bool await_suspend(std::coroutine_handle<> handle) {
+      handle_.promise().continuation_ = handle;
+      // If the task finished while we were storing the continuation then resume immediately
+      auto expected = task_state::running;
+      return handle_.promise().state_.compare_exchange_strong(expected, task_state::awaited, std::memory_order_acq_rel);
     }
     T await_resume() {
       auto& promise = handle_.promise();
@@ -103,21 +180,43 @@ namespace lcl::async {
   // Specialization for void return type
   template<>
   struct Task<void> {
-    struct promise_type {
-      std::exception_ptr exception_;
-
-      Task get_return_object() { return {std::coroutine_handle<promise_type>::from_promise(*this)}; }
+    struct promise_type : task_promise_base {
+      Task get_return_object() { return Task{std::coroutine_handle<promise_type>::from_promise(*this)}; }
       std::suspend_never initial_suspend() { return {}; }
-      std::suspend_always final_suspend() noexcept { return {}; }
+      final_awaiter final_suspend() noexcept { return {}; }
       void return_void() {}
-      void unhandled_exception() { exception_ = std::current_exception(); }
     };
 
-    [[nodiscard]] bool await_ready() const { return handle_.done(); }
-    void await_suspend(std::coroutine_handle<> handle) {
-      get_thread_pool().enqueue([handle]() mutable {
-        handle.resume();
-      });
+    explicit Task(const std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    Task& operator=(Task&& other) noexcept {
+      if (this != &other) {
+        detach();
+        handle_ = std::exchange(other.handle_, {});
+      }
+      return *this;
+    }
+
+    ~Task() {
+      detach();
+    }
+
+    // Gives up the task for fire-and-forget use; it keeps running and cleans up after itself
+    void detach() noexcept {
+      if (handle_) release_task_frame(std::exchange(handle_, {}));
+    }
+
+    [[nodiscard]] bool await_ready() const {
+      return handle_.promise().state_.load(std::memory_order_acquire) == task_state::completed;
+    }
+    bool await_suspend(std::coroutine_handle<> handle) {
+      handle_.promise().continuation_ = handle;
+      // If the task finished while we were storing the continuation then resume immediately
+      auto expected = task_state::running;
+      return handle_.promise().state_.compare_exchange_strong(expected, task_state::awaited, std::memory_order_acq_rel);
     }
     void await_resume() const {
       auto& promise = handle_.promise();
@@ -127,81 +226,191 @@ namespace lcl::async {
     std::coroutine_handle<promise_type> handle_;
   };
 
+  // A task that doesn't start until it is awaited. The awaiter runs its body directly; a body that completes
+  // synchronously lets the awaiter carry on without suspending, and one that suspended transfers back to the awaiter
+  // when it finishes. A chain of lazy tasks therefore runs on one thread with no pool hops, and any number of
+  // synchronous completions in a row use constant stack; only nesting depth grows it. The task owns its frame and must
+  // be awaited exactly once.
+  template<typename T>
+  struct LazyTask {
+    struct promise_type : lazy_promise_base {
+      std::optional<T> value_;
+
+      LazyTask get_return_object() { return LazyTask{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+      std::suspend_always initial_suspend() noexcept { return {}; }
+      lazy_final_awaiter final_suspend() noexcept { return {}; }
+      void return_value(T value) { value_ = std::move(value); }
+    };
+
+    explicit LazyTask(const std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    LazyTask(LazyTask&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    LazyTask(const LazyTask&) = delete;
+    LazyTask& operator=(const LazyTask&) = delete;
+    LazyTask& operator=(LazyTask&&) = delete;
+
+    ~LazyTask() {
+      if (handle_) handle_.destroy();
+    }
+
+    [[nodiscard]] bool await_ready() const noexcept { return handle_.done(); }
+    bool await_suspend(const std::coroutine_handle<> handle) noexcept { return start_lazy_task(handle_, handle); }
+    T await_resume() {
+      auto& promise = handle_.promise();
+      if (promise.exception_) std::rethrow_exception(promise.exception_);
+      return std::move(promise.value_.value());
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+  };
+
+  // Specialization for void return type
+  template<>
+  struct LazyTask<void> {
+    struct promise_type : lazy_promise_base {
+      LazyTask get_return_object() { return LazyTask{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+      std::suspend_always initial_suspend() noexcept { return {}; }
+      lazy_final_awaiter final_suspend() noexcept { return {}; }
+      void return_void() {}
+    };
+
+    explicit LazyTask(const std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+    LazyTask(LazyTask&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    LazyTask(const LazyTask&) = delete;
+    LazyTask& operator=(const LazyTask&) = delete;
+    LazyTask& operator=(LazyTask&&) = delete;
+
+    ~LazyTask() {
+      if (handle_) handle_.destroy();
+    }
+
+    [[nodiscard]] bool await_ready() const noexcept { return handle_.done(); }
+    bool await_suspend(const std::coroutine_handle<> handle) noexcept { return start_lazy_task(handle_, handle); }
+    void await_resume() const {
+      if (handle_.promise().exception_) std::rethrow_exception(handle_.promise().exception_);
+    }
+
+    std::coroutine_handle<promise_type> handle_;
+  };
+
   // Deferred task for manual resolution
   template<typename T>
   struct DeferredTask {
+    struct Promise;
+
+    // Rejects the promise when its stop token is triggered; holds it weakly so an abandoned promise is still freed
+    struct canceller {
+      std::weak_ptr<Promise> promise_;
+
+      void operator()() const;
+    };
+
     struct Promise {
       std::optional<T> value_;
       std::exception_ptr exception_;
       std::coroutine_handle<> continuation_;
-      bool is_resolved_ = false;
+      std::atomic<bool> is_resolved_ = false;
+      std::mutex mutex_;
+      std::optional<std::stop_callback<canceller>> stop_callback_;
+      // Resumes the awaiter once resolved
+      executor* executor_ = &get_thread_pool();
     };
 
     struct resolver {
       std::shared_ptr<Promise> promise_;
 
-      void resolve(T value) {
-        if (promise_->is_resolved_) return;
-        promise_->value_ = value;
-        promise_->is_resolved_ = true;
-        if (promise_->continuation_) {
-          get_thread_pool().enqueue([h = promise_->continuation_]() mutable {
-            if (h && !h.done()) h.resume();
-          });
+      void resolve(T value) const {
+        std::coroutine_handle<> continuation;
+        {
+          std::lock_guard lock(promise_->mutex_);
+          if (promise_->is_resolved_) return;
+          promise_->value_ = std::move(value);
+          promise_->is_resolved_ = true;
+          continuation = promise_->continuation_;
+        }
+        if (continuation) {
+          promise_->executor_->execute(continuation);
         }
       }
 
-      void reject(std::exception_ptr ex) {
-        if (promise_->is_resolved_) return;
-        promise_->exception_ = ex;
-        promise_->is_resolved_ = true;
-        if (promise_->continuation_) {
-          get_thread_pool().enqueue([h = promise_->continuation_]() mutable {
-            if (h && !h.done()) h.resume();
-          });
+      void reject(std::exception_ptr ex) const {
+        std::coroutine_handle<> continuation;
+        {
+          std::lock_guard lock(promise_->mutex_);
+          if (promise_->is_resolved_) return;
+          promise_->exception_ = ex;
+          promise_->is_resolved_ = true;
+          continuation = promise_->continuation_;
+        }
+        if (continuation) {
+          promise_->executor_->execute(continuation);
         }
       }
 
       template<typename E>
-      void reject(const E& ex) {
+      void reject(const E& ex) const {
         reject(std::make_exception_ptr(ex));
       }
+
+      // Rejects with cancelled_error once a stop is requested on token, unless resolved first. Call once, before the
+      // resolver is shared.
+      void cancel_on(const std::stop_token& token) const {
+        promise_->stop_callback_.emplace(token, canceller { promise_ });
+      }
     };
 
     // Constructor for manual resolution
     DeferredTask() : promise_(std::make_shared<Promise>()) {}
 
+    // Manual resolution, resuming the awaiter on resume_on rather than the global thread pool
+    explicit DeferredTask(executor& resume_on) : promise_(std::make_shared<Promise>()) {
+      promise_->executor_ = &resume_on;
+    }
+
     // Constructor accepting a callable
     explicit DeferredTask(std::function<Task<void>(resolver)> fn) : promise_(std::make_shared<Promise>()) {
       resolver res{promise_};
       try {
         get_thread_pool().enqueue([fn = std::move(fn), res]() mutable {
-          fn(res);
+          fn(res).detach();
         });
       } catch (...) {
         res.reject(std::current_exception());
       }
     }
 
-    bool await_ready() {
-      return promise_->is_resolved_;
-    }
+    DeferredTask(DeferredTask&&) noexcept = default;
+    DeferredTask& operator=(DeferredTask&&) noexcept = default;
+    DeferredTask(const DeferredTask&) = delete;
+    DeferredTask& operator=(const DeferredTask&) = delete;
 
-    void await_suspend(std::coroutine_handle<> handle) {
-      if (promise_->is_resolved_) {
-        get_thread_pool().enqueue([handle]() mutable {
-          if (handle && !handle.done()) handle.resume();
-        });
-      } else {
+    // Awaiting goes through a separate awaiter so the move-only DeferredTask itself is never copied into the frame; the
+    // awaiter shares the promise so a resumed awaiter can still read it after the DeferredTask is gone
+    struct awaiter {
+      std::shared_ptr<Promise> promise_;
+
+      [[nodiscard]] bool await_ready() const {
+        return promise_->is_resolved_;
+      }
+
+      bool await_suspend(std::coroutine_handle<> handle) const {
+        std::lock_guard lock(promise_->mutex_);
+        if (promise_->is_resolved_) {
+          return false;
+        }
         promise_->continuation_ = handle;
+        return true;
       }
-    }
 
-    T await_resume() {
-      if (promise_->exception_) {
-        std::rethrow_exception(promise_->exception_);
+      T await_resume() const {
+        if (promise_->exception_) {
+          std::rethrow_exception(promise_->exception_);
+        }
+        return *promise_->value_;
       }
-      return *promise_->value_;
+    };
+
+    awaiter operator co_await() const noexcept {
+      return {promise_};
     }
 
     resolver get_resolver() {
@@ -214,76 +423,120 @@ namespace lcl::async {
   // Specialization for void return type
   template<>
   struct DeferredTask<void> {
+    struct Promise;
+
+    // Rejects the promise when its stop token is triggered; holds it weakly so an abandoned promise is still freed
+    struct canceller {
+      std::weak_ptr<Promise> promise_;
+
+      void operator()() const;
+    };
+
     struct Promise {
       std::exception_ptr exception_;
       std::coroutine_handle<> continuation_;
-      bool is_resolved_ = false;
+      std::atomic<bool> is_resolved_ = false;
+      std::mutex mutex_;
+      std::optional<std::stop_callback<canceller>> stop_callback_;
+      // Resumes the awaiter once resolved
+      executor* executor_ = &get_thread_pool();
     };
 
     struct resolver {
       std::shared_ptr<Promise> promise_;
 
       void resolve() const {
-        if (promise_->is_resolved_) return;
-        promise_->is_resolved_ = true;
-        if (promise_->continuation_) {
-          get_thread_pool().enqueue([h = promise_->continuation_]() mutable {
-            if (h && !h.done()) h.resume();
-          });
+        std::coroutine_handle<> continuation;
+        {
+          std::lock_guard lock(promise_->mutex_);
+          if (promise_->is_resolved_) return;
+          promise_->is_resolved_ = true;
+          continuation = promise_->continuation_;
+        }
+        if (continuation) {
+          promise_->executor_->execute(continuation);
         }
       }
 
       void reject(const std::exception_ptr &ex) const {
-        if (promise_->is_resolved_) return;
-        promise_->exception_ = ex;
-        promise_->is_resolved_ = true;
-        if (promise_->continuation_) {
-          get_thread_pool().enqueue([h = promise_->continuation_]() mutable {
-            if (h && !h.done()) h.resume();
-          });
+        std::coroutine_handle<> continuation;
+        {
+          std::lock_guard lock(promise_->mutex_);
+          if (promise_->is_resolved_) return;
+          promise_->exception_ = ex;
+          promise_->is_resolved_ = true;
+          continuation = promise_->continuation_;
+        }
+        if (continuation) {
+          promise_->executor_->execute(continuation);
         }
       }
 
       template<typename E>
-      void reject(const E& ex) {
+      void reject(const E& ex) const {
         reject(std::make_exception_ptr(ex));
       }
+
+      // Rejects with cancelled_error once a stop is requested on token, unless resolved first. Call once, before the
+      // resolver is shared.
+      void cancel_on(const std::stop_token& token) const {
+        promise_->stop_callback_.emplace(token, canceller { promise_ });
+      }
     };
 
     // Constructor for manual resolution
     DeferredTask() : promise_(std::make_shared<Promise>()) {}
 
+    // Manual resolution, resuming the awaiter on resume_on rather than the global thread pool
+    explicit DeferredTask(executor& resume_on) : promise_(std::make_shared<Promise>()) {
+      promise_->executor_ = &resume_on;
+    }
+
     // Constructor accepting a callable
     explicit DeferredTask(std::function<Task<void>(resolver)> fn) : promise_(std::make_shared<Promise>()) {
       resolver res{promise_};
       try {
         get_thread_pool().enqueue([fn = std::move(fn), res]() mutable {
           // ReSharper disable once CppExpressionWithoutSideEffects
-          fn(res);
+          fn(res).detach();
         });
       } catch (...) {
         res.reject(std::current_exception());
       }
     }
 
-    [[nodiscard]] bool await_ready() const {
-      return promise_->is_resolved_;
-    }
+    DeferredTask(DeferredTask&&) noexcept = default;
+    DeferredTask& operator=(DeferredTask&&) noexcept = default;
+    DeferredTask(const DeferredTask&) = delete;
+    DeferredTask& operator=(const DeferredTask&) = delete;
 
-    void await_suspend(std::coroutine_handle<> handle) const {
-      if (promise_->is_resolved_) {
-        get_thread_pool().enqueue([handle]() mutable {
-          if (handle && !handle.done()) handle.resume();
-        });
-      } else {
+    // Awaiting goes through a separate awaiter so the move-only DeferredTask itself is never copied into the frame; the
+    // awaiter shares the promise so a resumed awaiter can still read it after the DeferredTask is gone
+    struct awaiter {
+      std::shared_ptr<Promise> promise_;
+
+      [[nodiscard]] bool await_ready() const {
+        return promise_->is_resolved_;
+      }
+
+      bool await_suspend(std::coroutine_handle<> handle) const {
+        std::lock_guard lock(promise_->mutex_);
+        if (promise_->is_resolved_) {
+          return false;
+        }
         promise_->continuation_ = handle;
+        return true;
       }
-    }
 
-    void await_resume() const {
-      if (promise_->exception_) {
-        std::rethrow_exception(promise_->exception_);
+      void await_resume() const {
+        if (promise_->exception_) {
+          std::rethrow_exception(promise_->exception_);
+        }
       }
+    };
+
+    awaiter operator co_await() const noexcept {
+      return {promise_};
     }
 
     [[nodiscard]] resolver get_resolver() const {
@@ -293,7 +546,48 @@ namespace lcl::async {
     std::shared_ptr<Promise> promise_;
   };
 
+  template<typename T>
+  void DeferredTask<T>::canceller::operator()() const {
+    if (auto promise = promise_.lock()) {
+      resolver { std::move(promise) }.reject(cancelled_error("Operation cancelled"));
+    }
+  }
+
+  inline void DeferredTask<void>::canceller::operator()() const {
+    if (auto promise = promise_.lock()) {
+      resolver { std::move(promise) }.reject(cancelled_error("Operation cancelled"));
+    }
+  }
+
   inline Task<void> yield() {
     co_return;
   }
+
+  // Blocks the calling thread until the task completes; for use at non-coroutine boundaries such as main()
+  template<typename T>
+  T sync_wait(Task<T>& task) {
+    if (!task.await_ready()) {
+      std::binary_semaphore completed{0};
+      auto signal = [](Task<T>& awaited, std::binary_semaphore& done) -> Task<void> {
+        try {
+          co_await awaited;
+        } catch (...) {
+          // Surfaced to the caller by await_resume below
+        }
+        done.release();
+      };
+      signal(task, completed).detach();
+      completed.acquire();
+    }
+    return task.await_resume();
+  }
+
+  template<typename T>
+  T sync_wait(LazyTask<T>& task) {
+    auto wrapper = [](LazyTask<T>& awaited) -> Task<T> {
+      co_return co_await awaited;
+    };
+    auto started = wrapper(task);
+    return sync_wait(started);
+  }
 }
\ No newline at end of file
@@ -0,0 +1,243 @@
+/*
+ * Tags: async, thread_pool, work-stealing, c++23
+ */
+
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "executor.hpp"
+#include "work_item.hpp"
+#include "work_stealing_deque.hpp"
+
+namespace lcl::async {
+  // Work-stealing thread pool. Each worker owns a Chase-Lev deque whose bottom acts as its LIFO slot: the owner takes the
+  // most recently scheduled task first, so a continuation enqueued by a running coroutine runs next on the same
+  // (cache-warm) thread, yet stays stealable if that worker goes on to run something long or blocks. Tasks enqueued
+  // from outside the pool go through a shared injection queue. Idle workers take from their own deque, then
+  // the injection queue, then steal from their siblings before parking. Work is carried as work_item::raw so
+  // resuming a coroutine never allocates.
+  class thread_pool final : public executor {
+    using task = work_item::raw;
+
+    struct worker {
+      worker(thread_pool* pool, const std::size_t index) : pool(pool), steal_seed(0x9E3779B97F4A7C15ull * (index + 1)) {}
+
+      thread_pool* pool;
+      work_stealing_deque<task> deque;
+      std::uint64_t steal_seed;
+      std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<worker>> workers_;
+
+    // Tasks enqueued from threads that aren't workers of this pool; a ring that only grows so steady-state pushes
+    // don't allocate
+    std::mutex injection_mutex_;
+    std::vector<task> injection_ = std::vector<task>(64);
+    std::size_t injection_head_ = 0;
+    std::atomic<std::size_t> injected_{0};
+
+    // Parking; epoch_ changes whenever new work may have become visible to a parked worker
+    std::mutex park_mutex_;
+    std::condition_variable park_cv_;
+    std::atomic<std::size_t> parked_{0};
+    std::atomic<std::uint64_t> epoch_{0};
+
+    std::atomic<bool> stop_{false};
+
+    static inline thread_local worker* current_worker_ = nullptr;
+
+    void run(worker& self) {
+      current_worker_ = &self;
+      while (true) {
+        if (const task next = find_work(self)) {
+          work_item::adopt(next)();
+          continue;
+        }
+        if (!park()) {
+          return;
+        }
+      }
+    }
+
+    task find_work(worker& self) {
+      if (const auto local = self.deque.take()) {
+        return *local;
+      }
+      if (const task injected = pop_injected()) {
+        return injected;
+      }
+      return steal(self);
+    }
+
+    void push_injected(const task& next) {
+      std::lock_guard lock(injection_mutex_);
+      const auto count = injected_.load(std::memory_order_relaxed);
+      if (count == injection_.size()) {
+        std::vector<task> bigger(injection_.size() * 2);
+        for (std::size_t i = 0; i < count; ++i) {
+          bigger[i] = injection_[(injection_head_ + i) % injection_.size()];
+        }
+        injection_ = std::move(bigger);
+        injection_head_ = 0;
+      }
+      injection_[(injection_head_ + count) % injection_.size()] = next;
+      injected_.store(count + 1, std::memory_order_release);
+    }
+
+    task pop_injected() {
+      if (injected_.load(std::memory_order_acquire) == 0) {
+        return {};
+      }
+      std::lock_guard lock(injection_mutex_);
+      const auto count = injected_.load(std::memory_order_relaxed);
+      if (count == 0) {
+        return {};
+      }
+      const task next = injection_[injection_head_];
+      injection_head_ = (injection_head_ + 1) % injection_.size();
+      injected_.store(count - 1, std::memory_order_release);
+      return next;
+    }
+
+    task steal(worker& self) {
+      const auto count = workers_.size();
+      // xorshift so thieves don't all hammer the same victim
+      self.steal_seed ^= self.steal_seed << 13;
+      self.steal_seed ^= self.steal_seed >> 7;
+      self.steal_seed ^= self.steal_seed << 17;
+      const auto start = static_cast<std::size_t>(self.steal_seed % count);
+      for (std::size_t i = 0; i < count; ++i) {
+        auto& victim = *workers_[(start + i) % count];
+        if (&victim == &self) continue;
+        if (const auto stolen = victim.deque.steal()) {
+          return *stolen;
+        }
+      }
+      return {};
+    }
+
+    [[nodiscard]] bool has_visible_work() const {
+      if (injected_.load(std::memory_order_acquire) > 0) {
+        return true;
+      }
+      for (const auto& worker : workers_) {
+        if (!worker->deque.empty()) return true;
+      }
+      return false;
+    }
+
+    // Returns false once the pool is stopping and there is no work left to drain
+    bool park() {
+      const auto epoch = epoch_.load(std::memory_order_seq_cst);
+      parked_.fetch_add(1, std::memory_order_seq_cst);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (has_visible_work()) {
+        parked_.fetch_sub(1, std::memory_order_seq_cst);
+        return true;
+      }
+      if (stop_.load()) {
+        parked_.fetch_sub(1, std::memory_order_seq_cst);
+        return false;
+      }
+
+      std::unique_lock lock(park_mutex_);
+      park_cv_.wait(lock, [this, epoch] { return epoch_.load() != epoch || stop_.load(); });
+      parked_.fetch_sub(1, std::memory_order_seq_cst);
+      return true;
+    }
+
+    void wake_one() {
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (parked_.load(std::memory_order_seq_cst) == 0) {
+        return;
+      }
+      {
+        std::lock_guard lock(park_mutex_);
+        epoch_.fetch_add(1, std::memory_order_seq_cst);
+      }
+      park_cv_.notify_one();
+    }
+
+  public:
+    explicit thread_pool(const size_t num_threads = std::thread::hardware_concurrency()) {
+      const auto count = std::max<size_t>(num_threads, 1);
+      workers_.reserve(count);
+      for (size_t i = 0; i < count; ++i) {
+        workers_.emplace_back(std::make_unique<worker>(this, i));
+      }
+      // Start the threads only once every worker exists; they steal from each other
+      for (auto& worker : workers_) {
+        worker->thread = std::thread([this, w = worker.get()] { run(*w); });
+      }
+    }
+
+    ~thread_pool() {
+      stop_.store(true);
+      {
+        std::lock_guard lock(park_mutex_);
+        epoch_.fetch_add(1);
+      }
+      park_cv_.notify_all();
+      for (auto& worker : workers_) {
+        worker->thread.join();
+      }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    // Accepts a coroutine handle, which is resumed directly, or any callable; see work_item for which callables are
+    // stored without allocating
+    void enqueue(work_item item) {
+      if (stop_.load()) {
+        throw std::runtime_error("Cannot enqueue on stopped thread pool");
+      }
+
+      const task next = item.release();
+      if (worker* self = current_worker_; self && self->pool == this) {
+        self->deque.push(next);
+      } else {
+        push_injected(next);
+      }
+      wake_one();
+    }
+
+    void execute(work_item item) override {
+      enqueue(std::move(item));
+    }
+
+    // Awaitable that resumes the awaiting coroutine on one of this pool's workers
+    auto schedule() {
+      struct awaiter {
+        thread_pool& pool;
+
+        [[nodiscard]] bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> handle) const {
+          pool.enqueue(handle);
+        }
+        void await_resume() const noexcept {}
+      };
+      return awaiter { *this };
+    }
+
+    [[nodiscard]] std::size_t size() const {
+      return workers_.size();
+    }
+  };
+
+  // Global thread pool accessor
+  inline thread_pool& get_thread_pool() {
+    static thread_pool pool{};
+    return pool;
+  }
+}
@@ -0,0 +1,57 @@
+/*
+ * Tags: async, timer, cancellation, c++23
+ */
+
+#pragma once
+#include <chrono>
+#include <concepts>
+#include <stop_token>
+#include <type_traits>
+#include <utility>
+
+#include "task.hpp"
+#include "timer.hpp"
+
+namespace lcl::async {
+  namespace detail {
+    template<typename T>
+    Task<void> settle(Task<T> task, typename DeferredTask<T>::resolver resolver, const timer_service::timer deadline) {
+      try {
+        if constexpr (std::is_void_v<T>) {
+          co_await task;
+          resolver.resolve();
+        } else {
+          resolver.resolve(co_await task);
+        }
+      } catch (...) {
+        resolver.reject(std::current_exception());
+      }
+      get_timer_service().cancel(deadline);
+    }
+  }
+
+  // Completes with the task's result, or throws timeout_error once timeout passes. The task can't be interrupted from
+  // outside; if it observes stop's token it's asked to wind down at the deadline, otherwise it finishes detached and
+  // its result is dropped.
+  template<typename T, typename Rep, typename Period>
+  Task<T> with_timeout(Task<T> task, const std::chrono::duration<Rep, Period> timeout,
+                       std::stop_source stop = std::stop_source(std::nostopstate)) {
+    DeferredTask<T> result;
+    auto resolver = result.get_resolver();
+    const auto deadline = get_timer_service().schedule_after(timeout, [resolver, stop]() mutable {
+      stop.request_stop();
+      resolver.reject(timeout_error("Operation timed out"));
+    });
+    detail::settle(std::move(task), resolver, deadline).detach();
+    co_return co_await result;
+  }
+
+  // Starts fn with a stop token that is triggered if it hasn't completed once timeout passes
+  template<typename F, typename Rep, typename Period>
+    requires std::invocable<F&, std::stop_token>
+  auto with_timeout(F fn, const std::chrono::duration<Rep, Period> timeout) {
+    std::stop_source stop;
+    auto task = fn(stop.get_token());
+    return with_timeout(std::move(task), timeout, std::move(stop));
+  }
+}
@@ -0,0 +1,140 @@
+/*
+ * Tags: async, timer, coroutine, c++23
+ */
+
+#pragma once
+#include <chrono>
+#include <condition_variable>
+#include <coroutine>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "thread_pool.hpp"
+#include "work_item.hpp"
+
+namespace lcl::async {
+  // Deadline scheduler backing timeouts and sleeps. A single thread waits on the earliest deadline in an ordered map
+  // and hands expired callbacks to the thread pool, so a callback never runs on (or blocks) the timer thread.
+  // Scheduling and cancelling are O(log n) and a cancelled timer's callback is destroyed immediately.
+  class timer_service {
+  public:
+    using clock = std::chrono::steady_clock;
+
+    struct timer {
+      clock::time_point deadline;
+      std::uint64_t id = 0;
+
+      auto operator<=>(const timer&) const = default;
+    };
+
+  private:
+    std::map<timer, work_item> timers_;
+    std::uint64_t next_id_ = 1;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    bool stop_ = false;
+    thread_pool& pool_;
+    std::thread thread_;
+
+    void run() {
+      std::unique_lock lock(mutex_);
+      while (!stop_) {
+        if (timers_.empty()) {
+          wake_.wait(lock);
+          continue;
+        }
+
+        const auto next = timers_.begin();
+        if (const auto deadline = next->first.deadline; clock::now() < deadline) {
+          // Waits on a copy: cancel() can erase this entry while we wait, and wait_until reads its deadline on waking
+          wake_.wait_until(lock, deadline);
+          continue;
+        }
+
+        auto callback = std::move(next->second);
+        timers_.erase(next);
+        lock.unlock();
+        pool_.enqueue(std::move(callback));
+        lock.lock();
+      }
+    }
+
+  public:
+    explicit timer_service(thread_pool& pool) : pool_(pool), thread_([this] { run(); }) {}
+
+    ~timer_service() {
+      {
+        std::lock_guard lock(mutex_);
+        stop_ = true;
+      }
+      wake_.notify_one();
+      thread_.join();
+    }
+
+    timer_service(const timer_service&) = delete;
+    timer_service& operator=(const timer_service&) = delete;
+
+    timer schedule_at(const clock::time_point deadline, work_item callback) {
+      timer scheduled;
+      bool earliest;
+      {
+        std::lock_guard lock(mutex_);
+        scheduled = { deadline, next_id_++ };
+        earliest = timers_.empty() || scheduled < timers_.begin()->first;
+        timers_.emplace(scheduled, std::move(callback));
+      }
+      if (earliest) {
+        wake_.notify_one();
+      }
+      return scheduled;
+    }
+
+    template<typename Rep, typename Period>
+    timer schedule_after(const std::chrono::duration<Rep, Period> delay, work_item callback) {
+      return schedule_at(clock::now() + std::chrono::duration_cast<clock::duration>(delay), std::move(callback));
+    }
+
+    // Returns true if the timer hadn't fired yet; its callback is destroyed without running
+    bool cancel(const timer& scheduled) {
+      work_item cancelled;
+      std::lock_guard lock(mutex_);
+      const auto it = timers_.find(scheduled);
+      if (it == timers_.end()) {
+        return false;
+      }
+      cancelled = std::move(it->second);
+      timers_.erase(it);
+      return true;
+    }
+
+    // Awaitable that resumes the awaiting coroutine on the thread pool once the delay has passed
+    template<typename Rep, typename Period>
+    auto sleep_for(const std::chrono::duration<Rep, Period> delay) {
+      struct awaiter {
+        timer_service& service;
+        clock::duration delay;
+
+        [[nodiscard]] bool await_ready() const noexcept { return delay <= clock::duration::zero(); }
+        void await_suspend(std::coroutine_handle<> handle) const {
+          service.schedule_after(delay, handle);
+        }
+        void await_resume() const noexcept {}
+      };
+      return awaiter { *this, std::chrono::duration_cast<clock::duration>(delay) };
+    }
+  };
+
+  // Global timer service accessor; callbacks run on get_thread_pool()
+  inline timer_service& get_timer_service() {
+    static timer_service service { get_thread_pool() };
+    return service;
+  }
+
+  template<typename Rep, typename Period>
+  auto sleep_for(const std::chrono::duration<Rep, Period> delay) {
+    return get_timer_service().sleep_for(delay);
+  }
+}
@@ -0,0 +1,138 @@
+/*
+ * Tags: async, thread_pool, c++23
+ */
+
+#pragma once
+#include <concepts>
+#include <coroutine>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace lcl::async {
+  // Move-only unit of work for thread_pool. A bare coroutine handle is stored as its address with no wrapper at all;
+  // callables that are trivially copyable and fit in inline_capacity (a lambda capturing a handle and a couple of
+  // pointers) are stored inline. Anything else is boxed on the heap.
+  class work_item {
+  public:
+    static constexpr std::size_t inline_capacity = 3 * sizeof(void*);
+
+    // Bitwise-copyable form carried through the pool's deques; exactly one work_item or pool slot owns it at a time.
+    // Kept trivial so the deques can copy it with memcpy; value-initialise it ({}) to get an empty one.
+    struct raw {
+      enum class op { run, destroy };
+
+      void (*invoke)(raw&, op);
+      alignas(void*) std::byte storage[inline_capacity];
+
+      explicit operator bool() const noexcept {
+        return invoke != nullptr;
+      }
+    };
+
+    static_assert(std::is_trivial_v<raw>);
+
+    template<typename F>
+    static constexpr bool fits_inline = sizeof(F) <= inline_capacity && alignof(F) <= alignof(void*) &&
+                                        std::is_trivially_copyable_v<F>;
+
+    work_item() noexcept = default;
+
+    work_item(const std::coroutine_handle<> handle) noexcept {
+      void* address = handle.address();
+      std::memcpy(raw_.storage, &address, sizeof(address));
+      raw_.invoke = &resume_handle;
+    }
+
+    template<typename F>
+      requires (!std::same_as<std::decay_t<F>, work_item> &&
+                !std::convertible_to<std::decay_t<F>, std::coroutine_handle<>> &&
+                std::invocable<std::decay_t<F>&>)
+    work_item(F&& func) {
+      using callable = std::decay_t<F>;
+      if constexpr (fits_inline<callable>) {
+        ::new (static_cast<void*>(raw_.storage)) callable(std::forward<F>(func));
+        raw_.invoke = &invoke_inline<callable>;
+      } else {
+        auto* boxed = new callable(std::forward<F>(func));
+        std::memcpy(raw_.storage, &boxed, sizeof(boxed));
+        raw_.invoke = &invoke_boxed<callable>;
+      }
+    }
+
+    work_item(work_item&& other) noexcept : raw_(std::exchange(other.raw_, {})) {}
+
+    work_item& operator=(work_item&& other) noexcept {
+      if (this != &other) {
+        reset();
+        raw_ = std::exchange(other.raw_, {});
+      }
+      return *this;
+    }
+
+    work_item(const work_item&) = delete;
+    work_item& operator=(const work_item&) = delete;
+
+    ~work_item() {
+      reset();
+    }
+
+    // Runs the work exactly once; the item is empty afterwards
+    void operator()() {
+      auto current = std::exchange(raw_, {});
+      current.invoke(current, raw::op::run);
+    }
+
+    explicit operator bool() const noexcept {
+      return static_cast<bool>(raw_);
+    }
+
+    [[nodiscard]] raw release() noexcept {
+      return std::exchange(raw_, {});
+    }
+
+    static work_item adopt(const raw& owned) noexcept {
+      work_item item;
+      item.raw_ = owned;
+      return item;
+    }
+
+  private:
+    raw raw_ {};
+
+    void reset() noexcept {
+      if (raw_) {
+        auto current = std::exchange(raw_, {});
+        current.invoke(current, raw::op::destroy);
+      }
+    }
+
+    static void resume_handle(raw& self, const raw::op op) {
+      if (op == raw::op::run) {
+        void* address;
+        std::memcpy(&address, self.storage, sizeof(address));
+        std::coroutine_handle<>::from_address(address).resume();
+      }
+    }
+
+    template<typename F>
+    static void invoke_inline(raw& self, const raw::op op) {
+      if (op == raw::op::run) {
+        (*std::launder(reinterpret_cast<F*>(self.storage)))();
+      }
+    }
+
+    template<typename F>
+    static void invoke_boxed(raw& self, const raw::op op) {
+      F* boxed;
+      std::memcpy(&boxed, self.storage, sizeof(boxed));
+      const std::unique_ptr<F> owned(boxed);
+      if (op == raw::op::run) {
+        (*owned)();
+      }
+    }
+  };
+}
@@ -0,0 +1,144 @@
+/*
+ * Tags: async, thread_pool, lock-free, c++23
+ * References:
+ * [1]: https://www.dre.vanderbilt.edu/~schmidt/PDF/work-stealing-dequeue.pdf
+ * [2]: https://fzn.fr/readings/ppopp13.pdf
+ */
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <vector>
+
+namespace lcl::async {
+  // Chase-Lev work-stealing deque [1] using the C11 memory orderings from [2]. The owning worker pushes and takes from
+  // the bottom without locking; any other thread may steal from the top. Values are copied in and out of the slots a
+  // word at a time with relaxed atomics, so a thief reading a slot that is concurrently being reused only ever sees a
+  // stale value, which its failed CAS on top then throws away.
+  template<typename T>
+  class work_stealing_deque {
+    static_assert(std::is_trivially_copyable_v<T>, "work_stealing_deque values are copied bitwise");
+
+    static constexpr std::size_t words = (sizeof(T) + sizeof(std::uintptr_t) - 1) / sizeof(std::uintptr_t);
+    using slot = std::array<std::atomic<std::uintptr_t>, words>;
+
+    struct ring {
+      explicit ring(const std::int64_t capacity)
+        : capacity(capacity), mask(capacity - 1), slots(std::make_unique<slot[]>(capacity)) {}
+
+      void put(const std::int64_t index, const T& value) {
+        std::array<std::uintptr_t, words> raw {};
+        std::memcpy(raw.data(), static_cast<const void*>(&value), sizeof(T));
+        auto& target = slots[index & mask];
+        for (std::size_t i = 0; i < words; ++i) {
+          target[i].store(raw[i], std::memory_order_relaxed);
+        }
+      }
+
+      T get(const std::int64_t index) const {
+        std::array<std::uintptr_t, words> raw {};
+        const auto& source = slots[index & mask];
+        for (std::size_t i = 0; i < words; ++i) {
+          raw[i] = source[i].load(std::memory_order_relaxed);
+        }
+        T value;
+        std::memcpy(static_cast<void*>(&value), raw.data(), sizeof(T));
+        return value;
+      }
+
+      std::int64_t capacity;
+      std::int64_t mask;
+      std::unique_ptr<slot[]> slots;
+    };
+
+    alignas(64) std::atomic<std::int64_t> top_{0};
+    alignas(64) std::atomic<std::int64_t> bottom_{0};
+    std::atomic<ring*> ring_;
+
+    // Every ring ever allocated; retired rings stay alive because a thief may still be reading from one. Owner only.
+    std::vector<std::unique_ptr<ring>> rings_;
+
+    ring* grow(ring* current, const std::int64_t bottom, const std::int64_t top) {
+      auto& bigger = rings_.emplace_back(std::make_unique<ring>(current->capacity * 2));
+      for (auto i = top; i < bottom; ++i) {
+        bigger->put(i, current->get(i));
+      }
+      ring_.store(bigger.get(), std::memory_order_release);
+      return bigger.get();
+    }
+
+  public:
+    explicit work_stealing_deque(const std::int64_t capacity = 256) {
+      ring_.store(rings_.emplace_back(std::make_unique<ring>(std::bit_ceil(static_cast<std::uint64_t>(capacity)))).get(),
+                  std::memory_order_relaxed);
+    }
+
+    work_stealing_deque(const work_stealing_deque&) = delete;
+    work_stealing_deque& operator=(const work_stealing_deque&) = delete;
+
+    // Owner only
+    void push(const T& value) {
+      const auto bottom = bottom_.load(std::memory_order_relaxed);
+      const auto top = top_.load(std::memory_order_acquire);
+      auto* current = ring_.load(std::memory_order_relaxed);
+      if (bottom - top > current->capacity - 1) {
+        current = grow(current, bottom, top);
+      }
+      current->put(bottom, value);
+      // A release store rather than a fence followed by a relaxed store: stealers acquire bottom_, and this form is one
+      // ThreadSanitizer can follow
+      bottom_.store(bottom + 1, std::memory_order_release);
+    }
+
+    // Owner only; pops the most recently pushed value
+    std::optional<T> take() {
+      const auto bottom = bottom_.load(std::memory_order_relaxed) - 1;
+      auto* current = ring_.load(std::memory_order_relaxed);
+      bottom_.store(bottom, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      auto top = top_.load(std::memory_order_relaxed);
+
+      if (top > bottom) {
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+        return std::nullopt;
+      }
+
+      std::optional value = current->get(bottom);
+      if (top == bottom) {
+        // Last value; race any thieves for it
+        if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+          value.reset();
+        }
+        bottom_.store(bottom + 1, std::memory_order_relaxed);
+      }
+      return value;
+    }
+
+    // Any thread; pops the oldest value. Returns std::nullopt when empty or when another thread won the race.
+    std::optional<T> steal() {
+      auto top = top_.load(std::memory_order_acquire);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      const auto bottom = bottom_.load(std::memory_order_acquire);
+      if (top >= bottom) {
+        return std::nullopt;
+      }
+
+      const auto* current = ring_.load(std::memory_order_acquire);
+      const T value = current->get(top);
+      if (!top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        return std::nullopt;
+      }
+      return value;
+    }
+
+    [[nodiscard]] bool empty() const {
+      return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+    }
+  };
+}
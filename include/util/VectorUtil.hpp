@@ -1,4 +1,5 @@
 #pragma once
+#include <span>
 
 #define TO_VECTOR_ARG_LITTLE_ENDIAN_U16(val) \
 static_cast<uint8_t>(((val) >> 0) & 0xFF), \
@@ -70,6 +71,24 @@ namespace lcl::util {
     return output;
   }
 
+  inline std::string toHexString(const std::span<const uint8_t> buffer) {
+    std::string output;
+    for (const auto byte : buffer) {
+      output += std::format("{:02X} ", static_cast<unsigned int>(byte));
+    }
+    if (!output.empty()) output.pop_back(); // Remove trailing space
+    return output;
+  }
+
+  inline std::string toDecimalString(const std::span<const uint8_t> buffer) {
+    std::string output;
+    for (const auto byte : buffer) {
+      output += std::format("{} ", static_cast<unsigned int>(byte));
+    }
+    if (!output.empty()) output.pop_back(); // Remove trailing space
+    return output;
+  }
+
   inline std::string toDecimalString(const std::vector<uint8_t> &buffer) {
     std::string output;
     for (const auto byte : buffer) {
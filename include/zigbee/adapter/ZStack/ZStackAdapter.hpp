@@ -8,17 +8,21 @@
 #include <zigbee/adapter/IAdapter.hpp>
 
 #include "ZigbeeNetworkProcessor.hpp"
+#include "ZnpFingerprint.hpp"
 
 namespace lcl::zigbee::adapter {
   using namespace zstack;
 
   class ZStackAdapter : public IAdapter {
     ZigbeeNetworkProcessor network_processor;
-    std::set<Capability> capabilities;
+    ZnpCapabilities capabilities;
     std::thread read_thread;
 
     std::optional<SysVersionResponse> version = std::nullopt;
     std::optional<ZnpMemoryAlignment> memory_alignment = std::nullopt;
+    std::chrono::milliseconds commissioning_timeout;
+    bool reconcile_commissioning;
+    std::optional<std::filesystem::path> state_file;
 
   public:
     explicit ZStackAdapter(const std::string &connection, ConnectionOptions options);
@@ -27,6 +31,19 @@ namespace lcl::zigbee::adapter {
     [[nodiscard]] TaskErrean<AdapterError> start() override;
   private:
     TaskErrean<ZStackError> initializeProcessor();
+
+    /**
+     * Restores the capabilities, version and memory alignment from the persisted fingerprint if it still describes the
+     * connected adapter.
+     *
+     * @return Whether the fingerprint matched
+     */
+    async::Task<bool> restoreFingerprint();
+
+    /**
+     * Queries the capabilities, version and memory alignment from the adapter and persists them as its fingerprint.
+     */
+    TaskErrean<ZStackError> probeProcessor();
     TaskErrean<ZStackError> beginCommissioning(const ZnpNetworkOptions &network_options, bool fail_on_collision, bool write_configuration_flag);
     TaskErrean<ZStackError> updateCommissioningItems(const ZnpNetworkOptions &network_options);
     TaskErrean<ZStackError> clearAdapter();
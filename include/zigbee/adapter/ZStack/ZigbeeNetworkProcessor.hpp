@@ -1,15 +1,74 @@
 #pragma once
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stop_token>
+#include <unordered_map>
+
+#include "ZnpDispatcher.hpp"
+#include "ZnpFrameDecoder.hpp"
+#include "ZnpNvCache.hpp"
+#include "ZnpNvSnapshot.hpp"
 #include "ZnpTypes.hpp"
 #include "asio/serial_port.hpp"
 #include "asio/ip/tcp.hpp"
+#include "async/asio_executor.hpp"
+#include "async/single_flight.hpp"
 #include "async/task.hpp"
+#include "async/timer.hpp"
 #include "result/Either.hpp"
 #include "zigbee/adapter/IAdapter.hpp"
 
 namespace lcl::zigbee::adapter::zstack {
-  constexpr uint8_t SOF = 0xFE;
-
   class ZigbeeNetworkProcessor {
+    template<typename T>
+    static bool succeeded(const EitherCmd<T> &result) {
+      return static_cast<bool>(result);
+    }
+
+    /**
+     * A framed request waiting for room in its in-flight window.
+     */
+    struct QueuedRequest {
+      ZnpFrameBuffer frame;
+      ZnpResponseKey response_key;
+      async::DeferredTask<RawZnpResponse>::resolver resolver;
+      uint8_t minimum_response_length = 0;
+    };
+
+    /**
+     * The requests awaiting one kind of response. Every waiter was built from the same command descriptor, so they
+     * share the shortest response they accept.
+     */
+    struct PendingResponses {
+      uint8_t minimum_length = 0;
+      std::deque<async::DeferredTask<RawZnpResponse>::resolver> waiters;
+    };
+
+    /**
+     * Shared with the deadline callbacks of outstanding requests, which can fire after the processor is gone. A callback
+     * only expires its request while {@link processor} is set; the destructor clears it and cancels every armed
+     * deadline. Guarded by {@link mutex}.
+     */
+    struct RequestDeadlines {
+      std::mutex mutex;
+      ZigbeeNetworkProcessor *processor = nullptr;
+      std::set<async::timer_service::timer> armed;
+    };
+
+    /**
+     * Bounds the number of requests of one kind that are awaiting a response on the wire. Requests beyond the limit are
+     * queued and written, in order, as responses free up room.
+     */
+    struct InFlightWindow {
+      uint8_t limit = 1;
+      uint8_t in_flight = 0;
+      std::deque<QueuedRequest> queued;
+    };
+
     ConnectionUri connection_uri;
     ConnectionOptions connection_options;
 
@@ -24,30 +83,88 @@ namespace lcl::zigbee::adapter::zstack {
     std::optional<asio::serial_port> serial_port;
     asio::io_context io_context;
 
+    /**
+     * Resumes coroutines awaiting a response on {@link read_thread}, right after the frame completing them is decoded.
+     */
+    async::io_context_executor response_executor { io_context.get_executor() };
+
     /**
      * Thread used for asynchronously reading device responses.
      */
     std::thread read_thread;
 
     /**
-     * A queue of read synchronous responses that haven't been handled yet.
+     * Reassembles frames from the bytes read off the transport. Guarded by {@link response_mutex}.
+     */
+    ZnpFrameDecoder frame_decoder;
+
+    /**
+     * Routes frames that didn't match a pending request (state changes, incoming messages, device announcements).
      */
-    std::vector<RawZnpResponse> responses;
+    ZnpDispatcher dispatcher;
+
+    /**
+     * Requests awaiting a response, keyed by the frame that completes them. Waiters sharing a key are completed in the
+     * order they were sent.
+     */
+    std::unordered_map<ZnpResponseKey, PendingResponses, ZnpResponseKey::Hash> pending_requests;
+
+    std::shared_ptr<RequestDeadlines> request_deadlines = std::make_shared<RequestDeadlines>();
 
     /**
-     * A lock guarding {@link responses}.
+     * Z-Stack only allows a single outstanding SREQ; the window is released as soon as its SRSP arrives.
+     */
+    InFlightWindow sreq_window;
+
+    /**
+     * AREQs awaiting a response AREQ (eg. SYS_RESET_REQ -> SYS_RESET_IND) overlap SREQs and each other, bounded per
+     * subsystem.
+     */
+    std::map<Subsystem, InFlightWindow> areq_windows;
+
+    /**
+     * A lock guarding {@link frame_decoder}, {@link pending_requests} and the in-flight windows.
      */
     mutable std::mutex response_mutex;
 
+    /**
+     * Admitted requests waiting to be written. Everything queued while a write is in progress goes out together in the
+     * next gather write, so frames are never interleaved on the wire. Guarded by {@link write_mutex}.
+     */
+    std::vector<QueuedRequest> write_queue;
+    bool write_in_progress = false;
+    std::mutex write_mutex;
+
+    /**
+     * The batch on the wire and the buffers gathering its frames. Only touched by the flush in progress; swapped with
+     * {@link write_queue} and cleared rather than reallocated, so steady-state writes don't allocate.
+     */
+    std::vector<QueuedRequest> write_batch;
+    std::vector<asio::const_buffer> write_buffers;
+
     /**
      * TODO: The current ZDP transaction ID.
      */
     const uint8_t zdp_transaction_id = 0x00;
 
     /**
-     * The current adapter's ZNP version.
+     * Read-only queries shared between concurrent callers. The version is kept until {@link getVersion} is asked to
+     * reload it; ping and device info are reused for {@link ConnectionOptions::query_ttl}. Failures aren't cached.
      */
-    std::optional<SysVersionResponse> version = std::nullopt;
+    async::single_flight<EitherCmd<SysVersionResponse>> version_query { succeeded<SysVersionResponse>, response_executor };
+    async::single_flight<EitherCmd<SysPingResponse>> ping_query { succeeded<SysPingResponse>, response_executor };
+    async::single_flight<EitherCmd<GetDeviceInfoResponse>> device_info_query { succeeded<GetDeviceInfoResponse>, response_executor };
+
+    /**
+     * Throughput of {@link readItem} and {@link writeItem}. Guarded by {@link nv_statistics_mutex}.
+     */
+    ZnpNvTransferStatistics nv_statistics;
+    mutable std::mutex nv_statistics_mutex;
+
+    /**
+     * Set when {@link ConnectionOptions::nv_cache} is enabled.
+     */
+    std::optional<ZnpNvCache> nv_cache;
 
   public:
     [[nodiscard]] ZigbeeNetworkProcessor(const std::string &connection_string, ConnectionOptions connection_options);
@@ -56,12 +173,57 @@ namespace lcl::zigbee::adapter::zstack {
     TaskErrean<AdapterError> connect();
     void startAsyncRead();
     void asyncRead();
-    void handleRead(const std::array<uint8_t, 256>& buffer, uint8_t size, std::vector<uint8_t> &pending_buffer);
+    void handleRead(std::span<const uint8_t> data);
 
     bool isInterPan() const {
       return is_inter_pan;
     }
 
+    /**
+     * Returns counters for frames decoded, dropped as corrupt and bytes skipped while resynchronizing.
+     */
+    [[nodiscard]] ZnpFrameStatistics frameStatistics() const;
+
+    /**
+     * Returns bytes, chunks and time spent moving NV items to and from the adapter.
+     */
+    [[nodiscard]] ZnpNvTransferStatistics nvTransferStatistics() const;
+
+    /**
+     * Returns NV cache hit, miss and coalescing counters, or std::nullopt if the cache is disabled.
+     */
+    [[nodiscard]] std::optional<ZnpNvCacheStatistics> nvCacheStatistics() const;
+
+    /**
+     * Seeds the NV cache with item lengths known from a previous run against the same adapter and firmware, so they
+     * needn't be queried again. Does nothing if the cache is disabled.
+     */
+    void primeItemLengths(const std::map<uint16_t, uint16_t> &item_lengths);
+
+    /**
+     * Returns the length of a Z-Stack non-volatile memory "item", from the NV cache when it holds one.
+     *
+     * @param configuration The configuration ID
+     * @return A {@link Either<SysOsalNvLengthResponse, ZnpCommandError>}
+     */
+    [[nodiscard]] TaskEitherCmd<SysOsalNvLengthResponse> getItemLength(DeviceConfiguration configuration);
+
+    /**
+     * Unsolicited frames (AREQ callbacks and indications) are delivered through here. Anything without a handler or
+     * subscription is dropped as soon as it's read.
+     */
+    [[nodiscard]] ZnpDispatcher &callbacks() {
+      return dispatcher;
+    }
+
+    /**
+     * Sets how many AREQs of a subsystem may be awaiting their response AREQ at once.
+     *
+     * @param subsystem The subsystem to configure
+     * @param limit The maximum number of in-flight AREQs; at least 1
+     */
+    void setAreqInFlightLimit(Subsystem subsystem, uint8_t limit);
+
     TaskEitherCmd<SysPingResponse> ping();
     TaskEitherCmd<SysResetCallback> reset(bool soft_reset = true);
     TaskEitherCmd<SysVersionResponse> getVersion(bool force_reload = false);
@@ -78,11 +240,49 @@ namespace lcl::zigbee::adapter::zstack {
     TaskEitherCmd<StatusableResponse> getActiveEndpoints(uint16_t destination_address, uint16_t network_address_of_interest);
     TaskEitherCmd<SysOsalNvReadResponse<ZnpMemoryAlignment>> getMemoryAlignment();
     TaskEitherCmd<StatusableResponse> setZdoDirectCallback(bool enabled);
+
+    /**
+     * Reads back the NV items written while commissioning a coordinator and compares them against
+     * {@param network_options}. Nothing is written.
+     *
+     * @return true if every item already holds the value commissioning would write
+     */
+    TaskEitherCmd<bool> networkItemsMatch(const ZnpNetworkOptions &network_options);
     TaskEitherCmd<StatusableResponse> setChannelList(const std::set<ZnpChannelMask> &channel_list);
     TaskEitherCmd<StatusableResponse> deleteNetworkInformationBlock();
     TaskEitherCmd<StatusableResponse> setBdbCommissioningChannel(bool is_primary, const std::set<ZnpChannelMask> &channels);
     TaskEitherCmd<StatusableResponse> startBdbCommissioning(ZnpCommissioningMode mode);
 
+    /**
+     * Waits for the adapter to come up as a coordinator, signalled by a ZDO_STATE_CHANGE_IND reaching
+     * {@link DEVICE_STATE_STARTED_AS_COORDINATOR} or a successful BDB commissioning notification. The returned task
+     * starts listening immediately, so create it before starting commissioning to be sure the indication isn't missed.
+     *
+     * @param timeout How long to wait for the network
+     * @param stop Stops waiting early; the handlers and deadline are removed before the task completes
+     * @return true once the network is up or false if commissioning reported a failure
+     * @throws async::timeout_error If neither indication arrives in time
+     * @throws async::cancelled_error If {@param stop} is requested first
+     */
+    [[nodiscard]] async::Task<bool> waitForCoordinatorStarted(std::chrono::milliseconds timeout, std::stop_token stop = {});
+
+    /**
+     * Reads the adapter's network state (addresses, NIB, keys, security material and link key tables) into a snapshot.
+     * Items the adapter doesn't have are left out; each table is read up to its first missing entry.
+     *
+     * @return A {@link Either<ZnpNvSnapshot, ZnpCommandError>}
+     */
+    TaskEitherCmd<ZnpNvSnapshot> backupNetworkState();
+
+    /**
+     * Writes every item in {@param snapshot} back to the adapter, resizing items whose length differs, and verifies each
+     * by reading it back. Refuses snapshots taken from another Z-Stack product. Reset the adapter afterwards so it
+     * starts from the restored state.
+     *
+     * @return A {@link Either<StatusableResponse, ZnpCommandError>}
+     */
+    TaskEitherCmd<StatusableResponse> restoreNetworkState(const ZnpNvSnapshot &snapshot);
+
   private:
     bool is_inter_pan = false;
 
@@ -90,13 +290,86 @@ namespace lcl::zigbee::adapter::zstack {
     void configureTcpDevice();
 
     /**
-     * Sends a ZNP request to the connected adapter.
-     * TODO: Error handling
+     * Sends a ZNP request to the connected adapter. The request isn't written until the returned task is awaited, and
+     * the awaiting command resumes inline once the response arrives.
      *
      * @param command The command to send
+     * @param timeout How long to wait for the response; defaults to {@link ConnectionOptions::request_timeout}
      * @return A response for the request
+     * @throws async::timeout_error If no response arrives in time
+     */
+    [[nodiscard]] async::LazyTask<RawZnpResponse> sendRequest(const ZnpCommand& command,
+                                                            std::optional<std::chrono::milliseconds> timeout = std::nullopt);
+
+    /**
+     * Abandons a request whose deadline passed: it stops waiting for a response, gives up its in-flight slot (or its
+     * place in the queue) and is rejected with an {@link async::timeout_error}. Does nothing if the response already
+     * arrived.
+     */
+    void expireRequest(const ZnpResponseKey &response_key, async::DeferredTask<RawZnpResponse>::resolver resolver);
+
+    /**
+     * Stops tracking {@param resolver} as awaiting {@param response_key}. Must be called with {@link response_mutex}
+     * held.
+     *
+     * @return Whether the resolver was still pending
+     */
+    bool removePendingRequest(const ZnpResponseKey &response_key,
+                              const async::DeferredTask<RawZnpResponse>::resolver &resolver);
+
+    /**
+     * Writes a request if its in-flight window has room, otherwise queues it behind earlier requests.
+     */
+    void scheduleRequest(QueuedRequest request);
+
+    /**
+     * Queues a request that has been admitted to its in-flight window for writing on {@link io_context}. The calling
+     * thread never blocks on the transport; write failures are handled by {@link failWrite}.
      */
-    [[nodiscard]] async::Task<RawZnpResponse> sendRequest(const ZnpCommand& command);
+    void dispatchRequest(QueuedRequest request);
+
+    /**
+     * Writes everything in {@link write_queue} with a single asynchronous gather write, then repeats until the queue
+     * drains. Runs on {@link io_context}.
+     */
+    void flushWrites();
+
+    /**
+     * Rejects a request whose frame couldn't be written and releases its slot to the next queued request.
+     */
+    void failWrite(QueuedRequest request, std::exception_ptr error);
+
+    /**
+     * Releases a slot in the window owning {@param response_key}, returning the next queued request admitted in its
+     * place. Must be called with {@link response_mutex} held.
+     */
+    std::optional<QueuedRequest> releaseInFlight(const ZnpResponseKey &response_key);
+
+    /**
+     * Returns the in-flight window responsible for requests completed by {@param response_key}. Must be called with
+     * {@link response_mutex} held.
+     */
+    InFlightWindow &inFlightWindow(const ZnpResponseKey &response_key);
+
+    /**
+     * Queues {@param commands} back-to-back so each SREQ is written as soon as the previous SRSP frees the window,
+     * instead of waiting for the caller to resume between chunks.
+     *
+     * @return The responses, in the order of {@param commands}
+     */
+    [[nodiscard]] async::Task<std::vector<RawZnpResponse>> sendPipelined(const std::vector<ZnpCommand> &commands);
+
+    /**
+     * Sends the read of the chunk of {@param configuration} starting at {@param offset}, using SYS_OSAL_NV_READ_EXT if
+     * {@param extended}. Starts immediately, so it can be queued alongside other requests.
+     */
+    [[nodiscard]] async::Task<RawZnpResponse> readItemChunk(DeviceConfiguration configuration, bool extended,
+                                                            std::size_t offset);
+
+    /**
+     * Whether the adapter understands SYS_OSAL_NV_READ_EXT and SYS_OSAL_NV_WRITE_EXT (Z-Stack 3.x).
+     */
+    [[nodiscard]] async::Task<bool> supportsExtendedNv();
 
     /**
      * Initializes a Z-Stack non-volatile memory "item".
@@ -113,38 +386,42 @@ namespace lcl::zigbee::adapter::zstack {
                                                                const std::vector<uint8_t>::const_iterator &end);
 
     /**
-     * Writes data to a Z-Stack non-volatile memory "item". This can handle initializing the memory if need be.
+     * Writes data to a Z-Stack non-volatile memory "item". This can handle initializing the memory if need be. The data
+     * is split into frame-sized chunks which are pipelined through {@link sendPipelined}. Writing what the NV cache
+     * already holds for the item is skipped.
      *
      * @param configuration The configuration ID
      * @param auto_initialize Whether to automatically initialize the data if the entry doesn't exist
+     * @param verify Whether to read the item back and fail if it doesn't match what was written
      * @return A {@link Either<StatusableResponse, ZnpCommandError>}
      */
     [[nodiscard]] TaskEitherCmd<StatusableResponse> writeItem(DeviceConfiguration configuration,
                                                           const std::vector<uint8_t> &,
-                                                          bool auto_initialize = true);
+                                                          bool auto_initialize = true,
+                                                          bool verify = false);
 
     /**
-     * Reads data from a Z-Stack non-volatile memory "item".
+     * Reads data from a Z-Stack non-volatile memory "item", answering from the NV cache when it can. Concurrent reads of
+     * the same item share one request.
+     *
      * @param configuration The configuration ID
      * @return A {@link Either<StatusableResponse, ZnpCommandError>}
      */
     [[nodiscard]] TaskEitherCmd<SysOsalNvReadResponse<std::vector<uint8_t>>> readItem(DeviceConfiguration configuration);
 
     /**
-     * Deletes a Z-Stack non-volatile memory "item".
-     *
-     * @param configuration The configuration ID
-     * @return A {@link Either<SysOsalNvDeleteResponse, ZnpCommandError>}
+     * Reads an NV item from the adapter. The first chunk is requested alongside the item length and the remaining
+     * chunks are pipelined through {@link sendPipelined}.
      */
-    [[nodiscard]] TaskEitherCmd<SysOsalNvDeleteResponse> deleteItem(DeviceConfiguration configuration);
+    [[nodiscard]] TaskEitherCmd<SysOsalNvReadResponse<std::vector<uint8_t>>> readItemFromAdapter(DeviceConfiguration configuration);
 
     /**
-     * Returns the length of a Z-Stack non-volatile memory "item".
+     * Deletes a Z-Stack non-volatile memory "item".
      *
      * @param configuration The configuration ID
-     * @return A {@link Either<SysOsalNvLengthResponse, ZnpCommandError>}
+     * @return A {@link Either<SysOsalNvDeleteResponse, ZnpCommandError>}
      */
-    [[nodiscard]] TaskEitherCmd<SysOsalNvLengthResponse> getItemLength(DeviceConfiguration configuration);
+    [[nodiscard]] TaskEitherCmd<SysOsalNvDeleteResponse> deleteItem(DeviceConfiguration configuration);
 
     /**
      *
@@ -0,0 +1,145 @@
+/**
+ * Tags: zigbee, zstack, commands
+ */
+#pragma once
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+
+#include "ZnpConstants.hpp"
+#include "ZnpTypes.hpp"
+
+namespace lcl::zigbee::adapter::zstack {
+  /**
+   * Describes one MT request: how it's framed, which frame answers it and how much of that frame its parser reads.
+   * Command ids are only unique within a subsystem, so descriptors are looked up by both.
+   */
+  struct ZnpCommandDescriptor {
+    Subsystem subsystem;
+    MtCommandId command;
+    Type type;
+
+    /**
+     * The AREQ that completes an AREQ request; SREQs are always completed by the SRSP sharing their id.
+     */
+    MtCommandId response;
+
+    /**
+     * The exact request payload length, or the length of its fixed header if {@link variable_length}.
+     */
+    uint8_t request_length;
+    bool variable_length;
+
+    /**
+     * The shortest response whose fields can all be read; anything shorter is rejected before it reaches a parser.
+     */
+    uint8_t minimum_response_length;
+  };
+
+  /**
+   * Describes an AREQ the adapter sends on its own, some of which complete AREQ requests.
+   */
+  struct ZnpCallbackDescriptor {
+    Subsystem subsystem;
+    MtCommandId command;
+    uint8_t minimum_length;
+  };
+
+  inline constexpr std::array ZNP_COMMANDS = {
+    //                    subsystem          command                             type  response       request len  variable  min response
+    ZnpCommandDescriptor { SUBSYSTEM_SYS,     SYS_RESET_REQ,                      AREQ, SYS_RESET_IND, 1,           false,    5 },
+    ZnpCommandDescriptor { SUBSYSTEM_SYS,     SYS_PING,                           SREQ, {},            0,           false,    2 },
+    ZnpCommandDescriptor { SUBSYSTEM_SYS,     SYS_VERSION,                        SREQ, {},            0,           false,    5 },
+    ZnpCommandDescriptor { SUBSYSTEM_SYS,     SYS_OSAL_NV_ITEM_INIT,              SREQ, {},            5,           true,     1 },
+    ZnpCommandDescriptor { SUBSYSTEM_SYS,     SYS_OSAL_NV_READ,                   SREQ, {},            3,           false,    2 },
+    ZnpCommandDescriptor { SUBSYSTEM_SYS,     SYS_OSAL_NV_WRITE,                  SREQ, {},            4,           true,     1 },
+    ZnpCommandDescriptor { SUBSYSTEM_SYS,     SYS_OSAL_NV_DELETE,                 SREQ, {},            4,           false,    1 },
+    ZnpCommandDescriptor { SUBSYSTEM_SYS,     SYS_OSAL_NV_LENGTH,                 SREQ, {},            2,           false,    2 },
+    ZnpCommandDescriptor { SUBSYSTEM_SYS,     SYS_OSAL_NV_READ_EXT,               SREQ, {},            4,           false,    2 },
+    ZnpCommandDescriptor { SUBSYSTEM_SYS,     SYS_OSAL_NV_WRITE_EXT,              SREQ, {},            6,           true,     1 },
+    ZnpCommandDescriptor { SUBSYSTEM_AF,      AF_REGISTER,                        SREQ, {},            73,          false,    1 },
+    ZnpCommandDescriptor { SUBSYSTEM_ZDO,     ZDO_ACTIVE_EP_REQ,                  SREQ, {},            5,           false,    1 },
+    ZnpCommandDescriptor { SUBSYSTEM_SAPI,    SAPI_WRITE_CONFIGURATION,           SREQ, {},            2,           true,     1 },
+    ZnpCommandDescriptor { SUBSYSTEM_UTIL,    UTIL_GET_DEVICE_INFO,               SREQ, {},            0,           false,    14 },
+    ZnpCommandDescriptor { SUBSYSTEM_UTIL,    UTIL_SET_PAN_ID,                    SREQ, {},            2,           false,    1 },
+    ZnpCommandDescriptor { SUBSYSTEM_UTIL,    UTIL_SET_CHANNELS,                  SREQ, {},            4,           false,    1 },
+    ZnpCommandDescriptor { SUBSYSTEM_APP_CNF, MT_APP_CNF_BDB_START_COMMISSIONING, SREQ, {},            1,           false,    1 },
+    ZnpCommandDescriptor { SUBSYSTEM_APP_CNF, MT_APP_CNF_BDB_SET_CHANNEL,         SREQ, {},            5,           false,    1 },
+  };
+
+  inline constexpr std::array ZNP_CALLBACKS = {
+    ZnpCallbackDescriptor { SUBSYSTEM_SYS,     SYS_RESET_IND,                             5 },
+    ZnpCallbackDescriptor { SUBSYSTEM_AF,      AF_INCOMING_MSG,                           17 },
+    ZnpCallbackDescriptor { SUBSYSTEM_ZDO,     ZDO_STATE_CHANGE_IND,                      1 },
+    ZnpCallbackDescriptor { SUBSYSTEM_ZDO,     ZDO_END_DEVICE_ANNCE_IND,                  13 },
+    ZnpCallbackDescriptor { SUBSYSTEM_APP_CNF, MT_APP_CNF_BDB_COMMISSIONING_NOTIFICATION, 3 },
+  };
+
+  /**
+   * Finds the descriptor for a request. Only usable in constant expressions, where a missing entry fails compilation.
+   */
+  consteval ZnpCommandDescriptor describeCommand(const Subsystem subsystem, const MtCommandId command) {
+    for (const auto &descriptor : ZNP_COMMANDS) {
+      if (descriptor.subsystem == subsystem && descriptor.command == command) {
+        return descriptor;
+      }
+    }
+    throw std::logic_error("Command is missing from ZNP_COMMANDS");
+  }
+
+  /**
+   * The shortest well-formed payload for a callback, or 0 for callbacks missing from {@link ZNP_CALLBACKS}.
+   */
+  constexpr uint8_t minimumCallbackLength(const Subsystem subsystem, const MtCommandId command) {
+    for (const auto &callback : ZNP_CALLBACKS) {
+      if (callback.subsystem == subsystem && callback.command == command) {
+        return callback.minimum_length;
+      }
+    }
+    return 0;
+  }
+
+  namespace detail {
+    consteval bool validCommandTable() {
+      for (std::size_t i = 0; i < ZNP_COMMANDS.size(); i++) {
+        const auto &descriptor = ZNP_COMMANDS[i];
+        if (descriptor.type != SREQ && descriptor.type != AREQ) return false;
+        if (descriptor.type == AREQ && minimumCallbackLength(descriptor.subsystem, descriptor.response) == 0) return false;
+        if (descriptor.request_length > ZNP_MAX_PAYLOAD_LENGTH) return false;
+        for (std::size_t j = i + 1; j < ZNP_COMMANDS.size(); j++) {
+          if (ZNP_COMMANDS[j].subsystem == descriptor.subsystem && ZNP_COMMANDS[j].command == descriptor.command) return false;
+        }
+      }
+      return true;
+    }
+  }
+
+  static_assert(detail::validCommandTable(), "ZNP_COMMANDS has a duplicate, mistyped or unanswerable entry");
+
+  /**
+   * Builds the command described by {@link ZNP_COMMANDS} for {@param Command} in {@param Subsys}, filling in its type,
+   * response and expected response length from the table.
+   *
+   * @throws std::length_error if {@param payload} doesn't match the described request length
+   */
+  template<Subsystem Subsys, MtCommandId Command>
+  ZnpCommand makeCommand(const ZnpPayload &payload = {}) {
+    static constexpr auto descriptor = describeCommand(Subsys, Command);
+
+    const bool fits = descriptor.variable_length
+      ? payload.size() >= descriptor.request_length
+      : payload.size() == descriptor.request_length;
+    if (!fits) {
+      throw std::length_error("ZNP payload doesn't match its command's layout");
+    }
+
+    return ZnpCommand {
+      Command,
+      Subsys,
+      descriptor.type,
+      payload,
+      descriptor.type == AREQ ? descriptor.response : MtCommandId {},
+      descriptor.minimum_response_length
+    };
+  }
+}
@@ -9,6 +9,29 @@
 #include "ZnpTypes.hpp"
 
 namespace lcl::zigbee::adapter::zstack {
+  /**
+   * The [begin, end) byte range of an NV item carried by a single read or write request.
+   */
+  struct ZnpNvChunk {
+    std::size_t begin;
+    std::size_t end;
+
+    bool operator==(const ZnpNvChunk&) const = default;
+  };
+
+  /**
+   * Splits bytes [{@param offset}, {@param length}) of an NV item into consecutive chunks of at most
+   * {@param chunk_length} bytes; only the last may be shorter.
+   *
+   * @throws std::invalid_argument if {@param chunk_length} is 0
+   */
+  std::vector<ZnpNvChunk> nvChunks(std::size_t offset, std::size_t length, std::size_t chunk_length);
+
+  /**
+   * Whether every chunk starts at an offset the non-extended NV commands can carry; see {@link ZNP_NV_MAX_SHORT_OFFSET}.
+   */
+  bool nvChunksFitShortOffsets(const std::vector<ZnpNvChunk> &chunks);
+
   ZnpCommand sysResetReq(bool soft_reset = true);
   ZnpCommand sysPing();
   ZnpCommand sysVersion();
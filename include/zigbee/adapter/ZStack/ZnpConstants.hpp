@@ -7,9 +7,34 @@
  */
 
 #pragma once
+#include <cstddef>
 #include <cstdint>
 
 namespace lcl::zigbee::adapter::zstack {
+  constexpr uint8_t SOF = 0xFE;
+
+  /**
+   * The largest payload a single MT frame can carry; longer length bytes can only come from line noise.
+   */
+  constexpr std::size_t ZNP_MAX_PAYLOAD_LENGTH = 250;
+
+  /**
+   * SOF, length, two command bytes and the trailing FCS.
+   */
+  constexpr std::size_t ZNP_FRAME_OVERHEAD = 5;
+
+  /**
+   * The most NV item bytes one request can carry: the payload limit less each command's header.
+   */
+  constexpr std::size_t ZNP_NV_WRITE_EXT_CHUNK_LENGTH = ZNP_MAX_PAYLOAD_LENGTH - 6;
+  constexpr std::size_t ZNP_NV_WRITE_CHUNK_LENGTH = ZNP_MAX_PAYLOAD_LENGTH - 4;
+  constexpr std::size_t ZNP_NV_ITEM_INIT_CHUNK_LENGTH = ZNP_MAX_PAYLOAD_LENGTH - 5;
+
+  /**
+   * The furthest offset SYS_OSAL_NV_READ and SYS_OSAL_NV_WRITE can address; their offset field is a single byte.
+   */
+  constexpr std::size_t ZNP_NV_MAX_SHORT_OFFSET = 0xFF;
+
   enum ZnpProductVersion {
     ZNP_VERSION_ZSTACK_12 = 0,
     ZNP_VERSION_ZSTACK_3x0 = 1,
@@ -54,13 +79,16 @@ namespace lcl::zigbee::adapter::zstack {
     UTIL_GET_DEVICE_INFO  = 0x00,
 
     AF_REGISTER           = 0x00,
+    AF_INCOMING_MSG       = 0x81,
 
     /**
      * The Active_EP_req command is generated from a local device wishing to acquire the list of endpoints on a
      * remote device with simple descriptors. This command SHALL be unicast either to the remote device itself or to an
      * alternative device that contains the discovery information of the remote device. [1]
      */
-    ZDO_ACTIVE_EP_REQ     = 0x05
+    ZDO_ACTIVE_EP_REQ     = 0x05,
+    ZDO_STATE_CHANGE_IND  = 0xC0,
+    ZDO_END_DEVICE_ANNCE_IND = 0xC1
   };
 
   enum Subsystem: uint8_t {
@@ -180,8 +208,18 @@ namespace lcl::zigbee::adapter::zstack {
     ZCD_NV_PRECFGKEYS = 0x62,
     ZCD_NV_PRECFGKEYS_ENABLE = 0x63,
 
+    ZCD_NV_EXTADDR = 0x01,
+    ZCD_NV_NWK_ACTIVE_KEY_INFO = 0x3A,
+    ZCD_NV_NWK_ALTERN_KEY_INFO = 0x3B,
+    ZCD_NV_TRUSTCENTER_ADDR = 0x71,
+    ZCD_NV_NWK_SEC_MATERIAL_TABLE_START = 0x75,
+    ZCD_NV_NWK_SEC_MATERIAL_TABLE_END = 0x80,
+
     // TODO: Used for legacy 1.2 stack [2]
-    ZCD_NV_LEGACY_TCLK_TABLE_START_12 = 257
+    ZCD_NV_LEGACY_TCLK_TABLE_START_12 = 257,
+    ZCD_NV_LEGACY_TCLK_TABLE_END_12 = 0x01FF,
+    ZCD_NV_APS_LINK_KEY_DATA_START = 0x0201,
+    ZCD_NV_APS_LINK_KEY_DATA_END = 0x02FF
   };
 
   enum ConfigurationProperty: uint8_t {
@@ -238,6 +276,27 @@ namespace lcl::zigbee::adapter::zstack {
     DEVICE_STATE_LOST_INFO_ABOUT_PARENT     = 0x0A
   };
 
+  /**
+   * The status reported by an APP_CNF_BDB_COMMISSIONING_NOTIFICATION.
+   */
+  enum BdbCommissioningStatus: uint8_t {
+    BDB_COMMISSIONING_SUCCESS                       = 0x00,
+    BDB_COMMISSIONING_IN_PROGRESS                   = 0x01,
+    BDB_COMMISSIONING_NO_NETWORK                    = 0x02,
+    BDB_COMMISSIONING_TL_TARGET_FAILURE             = 0x03,
+    BDB_COMMISSIONING_TL_NOT_AA_CAPABLE             = 0x04,
+    BDB_COMMISSIONING_TL_NO_SCAN_RESPONSE           = 0x05,
+    BDB_COMMISSIONING_TL_NOT_PERMITTED              = 0x06,
+    BDB_COMMISSIONING_TCLK_EX_FAILURE               = 0x07,
+    BDB_COMMISSIONING_FORMATION_FAILURE             = 0x08,
+    BDB_COMMISSIONING_FB_TARGET_IN_PROGRESS         = 0x09,
+    BDB_COMMISSIONING_FB_INITITATOR_IN_PROGRESS     = 0x0A,
+    BDB_COMMISSIONING_FB_NO_IDENTIFY_QUERY_RESPONSE = 0x0B,
+    BDB_COMMISSIONING_FB_BINDING_TABLE_FULL         = 0x0C,
+    BDB_COMMISSIONING_NETWORK_RESTORED              = 0x0D,
+    BDB_COMMISSIONING_FAILURE                       = 0x0E
+  };
+
   enum SysOsalNvDeleteStatus: uint8_t {
     SYS_OSAL_NV_DELETE_SUCCESS          = 0x00,
     SYS_OSAL_NV_DELETE_NO_ACTION_TAKEN  = 0x09,
@@ -245,6 +304,15 @@ namespace lcl::zigbee::adapter::zstack {
     SYS_OSAL_NV_DELETE_BAD_LENGTH       = 0x0C
   };
 
+  /**
+   * The status reported by SYS_OSAL_NV_ITEM_INIT. Creating a missing item is reported as 0x09 rather than success.
+   */
+  enum SysOsalNvItemInitStatus: uint8_t {
+    SYS_OSAL_NV_ITEM_INIT_ALREADY_EXISTS  = 0x00,
+    SYS_OSAL_NV_ITEM_INIT_CREATED         = 0x09,
+    SYS_OSAL_NV_ITEM_INIT_FAILURE         = 0x0A
+  };
+
   enum ZnpChannel: uint8_t {
     ZNP_CHANNEL_11 = 11,
     ZNP_CHANNEL_12 = 12,
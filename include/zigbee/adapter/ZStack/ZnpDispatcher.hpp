@@ -0,0 +1,145 @@
+/**
+ * Tags: zigbee, zstack, callbacks
+ */
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "ZnpTypes.hpp"
+#include "async/task.hpp"
+
+namespace lcl::zigbee::adapter::zstack {
+  /**
+   * Identifies a kind of unsolicited frame, eg. ZDO_STATE_CHANGE_IND or AF_INCOMING_MSG.
+   */
+  struct ZnpCallbackKey {
+    Subsystem subsystem;
+    MtCommandId command;
+
+    auto operator<=>(const ZnpCallbackKey&) const = default;
+  };
+
+  /**
+   * Counters describing where unsolicited frames went.
+   */
+  struct ZnpDispatchStatistics {
+    /**
+     * Frames handed to at least one handler or subscription.
+     */
+    uint64_t frames_dispatched = 0;
+
+    /**
+     * Frames nobody was listening for; they're freed as soon as they're read.
+     */
+    uint64_t frames_unhandled = 0;
+
+    /**
+     * Frames evicted from full subscription queues, summed over every subscription.
+     */
+    uint64_t frames_dropped = 0;
+  };
+
+  /**
+   * A bounded queue of the unsolicited frames matching one {@link ZnpCallbackKey}. Once full the oldest frame is
+   * dropped to make room, so a slow consumer sees the latest state rather than stalling the read thread. Frames are
+   * consumed by a single reader, either by awaiting {@link next} or polling {@link tryNext}. Unsubscribe by releasing
+   * the last reference.
+   */
+  class ZnpSubscription {
+  public:
+    ZnpSubscription(std::size_t capacity, async::executor &resume_on);
+
+    /**
+     * Returns the next queued frame, waiting for one to arrive if the queue is empty.
+     */
+    [[nodiscard]] async::LazyTask<RawZnpResponse> next();
+
+    /**
+     * Returns the next queued frame or std::nullopt if the queue is empty.
+     */
+    std::optional<RawZnpResponse> tryNext();
+
+    [[nodiscard]] std::size_t size() const;
+
+    /**
+     * How many frames were evicted because the queue was full.
+     */
+    [[nodiscard]] uint64_t dropped() const;
+
+  private:
+    friend class ZnpDispatcher;
+
+    const std::size_t capacity;
+    async::executor &resume_on;
+
+    mutable std::mutex mutex;
+    std::deque<RawZnpResponse> queued;
+    std::optional<async::DeferredTask<RawZnpResponse>::resolver> waiting;
+    uint64_t frames_dropped = 0;
+
+    /**
+     * Hands a frame to the waiting reader or queues it.
+     *
+     * @return Whether an older frame was dropped to make room
+     */
+    bool push(const RawZnpResponse &frame);
+  };
+
+  /**
+   * Routes unsolicited frames (those not completing a pending request) to the handlers and subscriptions registered for
+   * them. Each frame is routed once and then freed.
+   */
+  class ZnpDispatcher {
+  public:
+    using Handler = std::function<void(const RawZnpResponse&)>;
+    using HandlerId = uint64_t;
+
+    static constexpr std::size_t DEFAULT_QUEUE_CAPACITY = 16;
+
+    /**
+     * Registers a handler that's called on the read thread for every matching frame. Handlers must not block.
+     *
+     * @return An ID for {@link removeHandler}
+     */
+    HandlerId addHandler(ZnpCallbackKey key, Handler handler);
+
+    void removeHandler(HandlerId handler_id);
+
+    /**
+     * Starts queueing matching frames.
+     *
+     * @param key The frames to queue
+     * @param capacity The most frames queued at once; at least 1
+     * @param resume_on Where a reader awaiting {@link ZnpSubscription::next} is resumed
+     */
+    [[nodiscard]] std::shared_ptr<ZnpSubscription> subscribe(ZnpCallbackKey key,
+                                                             std::size_t capacity = DEFAULT_QUEUE_CAPACITY,
+                                                             async::executor &resume_on = async::get_thread_pool());
+
+    /**
+     * Routes a frame to everything registered for it. Handlers run on the calling thread, outside any lock.
+     *
+     * @return Whether anything was registered for the frame
+     */
+    bool dispatch(const RawZnpResponse &frame);
+
+    [[nodiscard]] ZnpDispatchStatistics statistics() const;
+
+  private:
+    struct Route {
+      std::vector<std::pair<HandlerId, std::shared_ptr<const Handler>>> handlers;
+      std::vector<std::weak_ptr<ZnpSubscription>> subscriptions;
+    };
+
+    mutable std::mutex mutex;
+    std::map<ZnpCallbackKey, Route> routes;
+    HandlerId next_handler_id = 1;
+    ZnpDispatchStatistics stats;
+  };
+}
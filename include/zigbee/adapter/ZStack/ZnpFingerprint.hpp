@@ -0,0 +1,54 @@
+/**
+ * Tags: zigbee, zstack, persistence
+ */
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+
+#include "ZnpTypes.hpp"
+
+namespace lcl::zigbee::adapter::zstack {
+  /**
+   * What startup learns about an adapter by probing it, persisted so a restart against the same adapter and firmware
+   * can skip the probe. A fingerprint is trusted only while the adapter's IEEE address and firmware version still
+   * match; both are cheap to read.
+   */
+  struct ZnpFingerprint {
+    /**
+     * Bumped whenever the file layout changes; files written with another version are ignored.
+     */
+    static constexpr uint8_t FORMAT_VERSION = 1;
+
+    std::string ieee_address;
+    SysVersionResponse version;
+    ZnpCapabilities capabilities;
+    ZnpMemoryAlignment memory_alignment;
+
+    /**
+     * Lengths of NV items whose size the firmware fixes, keyed by item ID; used to prime the NV cache on a warm start.
+     */
+    std::map<uint16_t, uint16_t> item_lengths;
+
+    /**
+     * Whether this fingerprint describes the adapter reporting {@param ieee_address} and {@param version}.
+     */
+    [[nodiscard]] bool matches(const IEEEAddress &ieee_address, const SysVersionResponse &version) const;
+
+    /**
+     * Reads a fingerprint written by {@link save}.
+     *
+     * @return The fingerprint or std::nullopt if the file is missing, unreadable or from another format version
+     */
+    [[nodiscard]] static std::optional<ZnpFingerprint> load(const std::filesystem::path &path);
+
+    /**
+     * Writes the fingerprint, replacing any previous file atomically.
+     *
+     * @return Whether the file was written
+     */
+    bool save(const std::filesystem::path &path) const;
+  };
+}
@@ -0,0 +1,115 @@
+/**
+ * Tags: zigbee, zstack, framing
+ */
+#pragma once
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+#include "ZnpTypes.hpp"
+
+namespace lcl::zigbee::adapter::zstack {
+  /**
+   * A decoded frame whose payload points into the decoder's receive buffer. The view is only valid until the next call
+   * to {@link ZnpFrameDecoder::write}; call {@link materialize} to keep it.
+   */
+  struct ZnpFrameView {
+    MtCommandId command;
+    Subsystem subsystem;
+    Type type;
+    std::span<const uint8_t> payload;
+
+    [[nodiscard]] RawZnpResponse materialize() const;
+  };
+
+  /**
+   * Counters describing the health of the byte stream coming from the adapter.
+   */
+  struct ZnpFrameStatistics {
+    /**
+     * Frames that passed validation and were handed out.
+     */
+    uint64_t frames_decoded = 0;
+
+    /**
+     * Frames dropped because their FCS didn't match.
+     */
+    uint64_t checksum_failures = 0;
+
+    /**
+     * Frames dropped because their length byte exceeded {@link ZNP_MAX_PAYLOAD_LENGTH}.
+     */
+    uint64_t length_failures = 0;
+
+    /**
+     * Bytes skipped while scanning for the next SOF.
+     */
+    uint64_t bytes_discarded = 0;
+
+    [[nodiscard]] uint64_t framesDropped() const {
+      return checksum_failures + length_failures;
+    }
+  };
+
+  /**
+   * Incrementally decodes ZNP frames out of a fixed-capacity ring buffer. Bytes are copied in once as they're read from
+   * the transport and frames are handed out as views; a payload is only copied again if it straddles the end of the
+   * ring.
+   */
+  class ZnpFrameDecoder {
+  public:
+    /**
+     * Must be a power of two and comfortably larger than two maximum sized frames.
+     */
+    static constexpr std::size_t CAPACITY = 1024;
+
+    /**
+     * Appends received bytes to the ring.
+     *
+     * @param data The received bytes
+     * @return How many bytes were accepted; less than {@param data}'s size if the ring is full
+     */
+    std::size_t write(std::span<const uint8_t> data);
+
+    /**
+     * Decodes the next complete frame, if any. Bytes preceding a SOF are skipped and frames with an invalid length or
+     * FCS are dropped; in both cases decoding resynchronizes on the next SOF so a single corrupt byte only costs the
+     * frame it landed in.
+     *
+     * @return The next frame or std::nullopt if more bytes are needed
+     */
+    std::optional<ZnpFrameView> next();
+
+    [[nodiscard]] std::size_t size() const {
+      return tail - head;
+    }
+
+    [[nodiscard]] const ZnpFrameStatistics &statistics() const {
+      return stats;
+    }
+
+  private:
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be a power of two");
+    static_assert(CAPACITY >= 2 * (ZNP_MAX_PAYLOAD_LENGTH + ZNP_FRAME_OVERHEAD));
+
+    std::array<uint8_t, CAPACITY> ring = {};
+
+    /**
+     * Payloads that wrap around the end of {@link ring} are made contiguous here.
+     */
+    std::array<uint8_t, ZNP_MAX_PAYLOAD_LENGTH> wrapped_payload = {};
+
+    /**
+     * Monotonic read and write positions; masked with CAPACITY - 1 when indexing {@link ring}.
+     */
+    std::size_t head = 0;
+    std::size_t tail = 0;
+
+    ZnpFrameStatistics stats;
+
+    [[nodiscard]] uint8_t at(const std::size_t offset) const {
+      return ring[(head + offset) & (CAPACITY - 1)];
+    }
+  };
+}
@@ -0,0 +1,120 @@
+/**
+ * Tags: zigbee, zstack, nv
+ */
+#pragma once
+#include <cstdint>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "ZnpTypes.hpp"
+#include "async/task.hpp"
+
+namespace lcl::zigbee::adapter::zstack {
+  /**
+   * Counters describing how often NV lookups were answered without touching the adapter.
+   */
+  struct ZnpNvCacheStatistics {
+    /**
+     * Lengths and contents answered from the cache.
+     */
+    uint64_t hits = 0;
+
+    /**
+     * Lookups that had to go to the adapter.
+     */
+    uint64_t misses = 0;
+
+    /**
+     * Reads that joined another read of the same item already in flight instead of sending their own.
+     */
+    uint64_t coalesced = 0;
+  };
+
+  /**
+   * Host-side copy of NV item lengths and contents, kept coherent by writing through every NV write and clearing on
+   * reset. Items Z-Stack rewrites on its own while running (the NIB, the network key and its frame counter, key info and
+   * security material and link key tables) only have their lengths cached.
+   *
+   * Concurrent reads of one item are coalesced: the first reader {@link beginRead}s and goes to the adapter, later
+   * readers wait for its result. A read that overlaps an invalidation still returns to its waiters but isn't cached.
+   */
+  class ZnpNvCache {
+  public:
+    using ReadResult = EitherCmd<SysOsalNvReadResponse<std::vector<uint8_t>>>;
+
+    /**
+     * Either a read to wait on, or the go-ahead to read the item and report back through {@link finishRead}.
+     */
+    struct ReadTicket {
+      /**
+       * Set if another read of the item is in flight; await it instead of reading.
+       */
+      std::optional<async::DeferredTask<ReadResult>> in_flight;
+
+      /**
+       * Passed back to {@link finishRead} so a read overlapping an invalidation isn't cached.
+       */
+      uint64_t generation = 0;
+    };
+
+    explicit ZnpNvCache(async::executor &resume_on);
+
+    [[nodiscard]] std::optional<uint16_t> length(uint16_t item);
+    [[nodiscard]] std::optional<std::vector<uint8_t>> contents(uint16_t item);
+
+    void storeLength(uint16_t item, uint16_t length);
+
+    /**
+     * Records what the adapter holds for {@param item} after a successful write. Reads already in flight won't be
+     * cached over it.
+     */
+    void storeContents(uint16_t item, const std::vector<uint8_t> &data);
+
+    /**
+     * Forgets {@param item}; in-flight reads of it won't be cached.
+     */
+    void invalidate(uint16_t item);
+
+    /**
+     * Forgets everything, eg. after the adapter resets.
+     */
+    void clear();
+
+    [[nodiscard]] ReadTicket beginRead(uint16_t item);
+
+    /**
+     * Completes the read started by {@link beginRead}, caching a successful result and handing it to every waiter.
+     */
+    void finishRead(uint16_t item, uint64_t generation, const ReadResult &result);
+
+    /**
+     * Fails every waiter on the read started by {@link beginRead} with {@param exception}.
+     */
+    void abandonRead(uint16_t item, std::exception_ptr exception);
+
+    [[nodiscard]] ZnpNvCacheStatistics statistics() const;
+
+    /**
+     * Whether Z-Stack may change {@param item} without the host writing it.
+     */
+    [[nodiscard]] static bool isVolatile(uint16_t item);
+
+  private:
+    struct Entry {
+      std::optional<uint16_t> length;
+      std::optional<std::vector<uint8_t>> contents;
+    };
+
+    async::executor &resume_on;
+    mutable std::mutex mutex;
+    std::map<uint16_t, Entry> entries;
+    std::map<uint16_t, std::vector<async::DeferredTask<ReadResult>::resolver>> waiting_reads;
+    uint64_t generation = 0;
+    ZnpNvCacheStatistics stats;
+
+    std::vector<async::DeferredTask<ReadResult>::resolver> takeWaiters(uint16_t item);
+  };
+}
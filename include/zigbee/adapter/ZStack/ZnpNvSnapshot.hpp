@@ -0,0 +1,66 @@
+/**
+ * Tags: zigbee, zstack, persistence
+ */
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <map>
+#include <optional>
+#include <vector>
+
+namespace lcl::zigbee::adapter::zstack {
+  /**
+   * A copy of an adapter's network state as raw NV items, for moving a network onto a replacement adapter or restoring
+   * one without re-pairing every device.
+   *
+   * On disk a snapshot is a little-endian binary stream: the magic "LCLN", {@link FORMAT_VERSION}, the Z-Stack product
+   * ID it was taken from and the item count, then one (item ID, length, data) record per item, and finally a CRC-32 of
+   * everything before it.
+   */
+  struct ZnpNvSnapshot {
+    /**
+     * Bumped whenever the layout changes; snapshots written with another version are rejected.
+     */
+    static constexpr uint8_t FORMAT_VERSION = 1;
+
+    /**
+     * The {@link SysVersionResponse::product_id} of the adapter the snapshot was taken from. Item layouts differ between
+     * Z-Stack releases, so a snapshot only restores onto the same product.
+     */
+    uint8_t product_id = 0;
+
+    /**
+     * Item contents keyed by item ID.
+     */
+    std::map<uint16_t, std::vector<uint8_t>> items;
+
+    /**
+     * Streams the snapshot out record by record.
+     *
+     * @return Whether every byte was written
+     */
+    bool write(std::ostream &stream) const;
+
+    /**
+     * Streams a snapshot in, checking its format version and checksum.
+     *
+     * @return The snapshot or std::nullopt if the stream is truncated, corrupt or from another format version
+     */
+    [[nodiscard]] static std::optional<ZnpNvSnapshot> read(std::istream &stream);
+
+    /**
+     * Writes the snapshot to {@param path}, replacing any previous file atomically.
+     *
+     * @return Whether the file was written
+     */
+    bool save(const std::filesystem::path &path) const;
+
+    /**
+     * Reads a snapshot written by {@link save}.
+     *
+     * @return The snapshot or std::nullopt if the file is missing or unreadable
+     */
+    [[nodiscard]] static std::optional<ZnpNvSnapshot> load(const std::filesystem::path &path);
+  };
+}
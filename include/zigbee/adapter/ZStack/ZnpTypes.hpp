@@ -1,7 +1,17 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
 #include <cstdint>
+#include <filesystem>
+#include <format>
+#include <functional>
+#include <initializer_list>
 #include <iomanip>
+#include <iterator>
 #include <set>
+#include <span>
+#include <stdexcept>
 
 #include "ZnpConstants.hpp"
 #include "asio/serial_port.hpp"
@@ -37,15 +47,184 @@ namespace lcl::zigbee::adapter::zstack {
     using ValueType = void;
   };
 
+  /**
+   * A command payload stored inline, so building a command and framing it never allocates. Holds at most
+   * {@link ZNP_MAX_PAYLOAD_LENGTH} bytes; growing past that throws std::length_error.
+   */
+  class ZnpPayload {
+  public:
+    ZnpPayload() = default;
+
+    explicit ZnpPayload(const std::size_t size) {
+      resize(size);
+    }
+
+    ZnpPayload(const std::initializer_list<uint8_t> bytes) {
+      append(bytes.begin(), bytes.end());
+    }
+
+    void resize(const std::size_t size) {
+      if (size > bytes_.size()) {
+        throw std::length_error("ZNP payload exceeds the MT frame limit");
+      }
+      std::fill(bytes_.begin() + std::min<std::size_t>(size_, size), bytes_.begin() + size, 0);
+      size_ = static_cast<uint8_t>(size);
+    }
+
+    template<typename Iterator>
+    void append(Iterator begin, const Iterator end) {
+      const auto offset = size_;
+      resize(size_ + static_cast<std::size_t>(std::distance(begin, end)));
+      std::copy(begin, end, bytes_.begin() + offset);
+    }
+
+    [[nodiscard]] uint8_t &at(const std::size_t index) {
+      if (index >= size_) {
+        throw std::out_of_range("ZNP payload index out of range");
+      }
+      return bytes_[index];
+    }
+
+    [[nodiscard]] std::size_t size() const {
+      return size_;
+    }
+
+    [[nodiscard]] bool empty() const {
+      return size_ == 0;
+    }
+
+    [[nodiscard]] std::span<const uint8_t> bytes() const {
+      return { bytes_.data(), size_ };
+    }
+
+  private:
+    std::array<uint8_t, ZNP_MAX_PAYLOAD_LENGTH> bytes_ {};
+    uint8_t size_ = 0;
+  };
+
+  /**
+   * A complete MT frame ready for the wire: SOF, length, command bytes, payload and FCS.
+   */
+  struct ZnpFrameBuffer {
+    std::array<uint8_t, ZNP_MAX_PAYLOAD_LENGTH + ZNP_FRAME_OVERHEAD> bytes;
+    std::size_t size = 0;
+
+    [[nodiscard]] std::span<const uint8_t> view() const {
+      return { bytes.data(), size };
+    }
+  };
+
+  /**
+   * A read-only view over a received payload that decodes little-endian fields in place. Parsers check the length once
+   * with {@link has} and then read fields without copying the payload.
+   */
+  class ZnpPayloadReader {
+  public:
+    explicit ZnpPayloadReader(const std::span<const uint8_t> payload) : payload_(payload) {}
+
+    /**
+     * Whether at least {@param length} bytes arrived; every offset below that may then be read.
+     */
+    [[nodiscard]] bool has(const std::size_t length) const {
+      return payload_.size() >= length;
+    }
+
+    [[nodiscard]] std::size_t size() const {
+      return payload_.size();
+    }
+
+    [[nodiscard]] uint8_t u8(const std::size_t offset) const {
+      return payload_[offset];
+    }
+
+    [[nodiscard]] uint16_t u16(const std::size_t offset) const {
+      return static_cast<uint16_t>(payload_[offset] | payload_[offset + 1] << 8);
+    }
+
+    [[nodiscard]] uint32_t u32(const std::size_t offset) const {
+      return static_cast<uint32_t>(u16(offset)) | static_cast<uint32_t>(u16(offset + 2)) << 16;
+    }
+
+    [[nodiscard]] uint64_t u64(const std::size_t offset) const {
+      return static_cast<uint64_t>(u32(offset)) | static_cast<uint64_t>(u32(offset + 4)) << 32;
+    }
+
+  private:
+    std::span<const uint8_t> payload_;
+  };
+
   struct ZnpCommand {
     MtCommandId commandId;
     Subsystem subsystem;
     Type type;
-    std::vector<uint8_t> data;
+    ZnpPayload data;
     MtCommandId responseId = {};
+
+    /**
+     * Responses shorter than this are truncated and rejected rather than handed to a parser.
+     */
+    uint8_t minimumResponseLength = 0;
+
+    /**
+     * Frames the command for writing, computing its FCS as the bytes are laid down.
+     */
+    [[nodiscard]] ZnpFrameBuffer frame() const;
+  };
+
+  /**
+   * Counters for NV item transfers, for spotting slow links or adapters.
+   */
+  struct ZnpNvTransferStatistics {
+    uint64_t bytes_read = 0;
+    uint64_t bytes_written = 0;
+    uint64_t chunks_read = 0;
+    uint64_t chunks_written = 0;
+    std::chrono::nanoseconds read_time {};
+    std::chrono::nanoseconds write_time {};
+
+    [[nodiscard]] double readBytesPerSecond() const {
+      return read_time.count() > 0 ? bytes_read / std::chrono::duration<double>(read_time).count() : 0;
+    }
+
+    [[nodiscard]] double writeBytesPerSecond() const {
+      return write_time.count() > 0 ? bytes_written / std::chrono::duration<double>(write_time).count() : 0;
+    }
   };
 
-  struct ConnectionOptions { };
+  struct ConnectionOptions {
+    /**
+     * How long a request waits for its response before it's abandoned with an {@link async::timeout_error}.
+     */
+    std::chrono::milliseconds request_timeout = std::chrono::seconds(5);
+
+    /**
+     * How long startup waits for the coordinator to form or restore its network once commissioning has begun.
+     */
+    std::chrono::milliseconds commissioning_timeout = std::chrono::seconds(60);
+
+    /**
+     * Skip wiping and rewriting the adapter's network configuration at startup when its NV items already match the
+     * requested network.
+     */
+    bool reconcile_commissioning = true;
+
+    /**
+     * Where to persist the adapter's {@link ZnpFingerprint} so restarts can skip probing it. Disabled when unset.
+     */
+    std::optional<std::filesystem::path> state_file = std::nullopt;
+
+    /**
+     * Keep a host-side copy of NV item lengths and contents so repeated reads, and writes of unchanged values, don't
+     * go to the adapter.
+     */
+    bool nv_cache = true;
+
+    /**
+     * How long ping and device info results are reused. Concurrent requests share one round trip regardless; zero
+     * disables reuse beyond that.
+     */
+    std::chrono::milliseconds query_ttl = std::chrono::seconds(1);
+  };
 
   struct SerialConnectionOptions: ConnectionOptions {
     uint32_t baud_rate = 115200;
@@ -75,6 +254,28 @@ namespace lcl::zigbee::adapter::zstack {
     std::vector<uint8_t> payload;
   };
 
+  /**
+   * Identifies the frame that completes a pending request.
+   */
+  struct ZnpResponseKey {
+    Subsystem subsystem;
+    MtCommandId command;
+    Type type;
+
+    /**
+     * The key of the response expected for a request; an SRSP for SREQs and the command's response AREQ for AREQs.
+     */
+    [[nodiscard]] static ZnpResponseKey forRequest(const ZnpCommand& command);
+
+    auto operator<=>(const ZnpResponseKey&) const = default;
+
+    struct Hash {
+      std::size_t operator()(const ZnpResponseKey &key) const noexcept {
+        return static_cast<std::size_t>(key.subsystem) << 16 | static_cast<std::size_t>(key.command) << 8 | key.type;
+      }
+    };
+  };
+
   template <typename T>
   using TaskEitherCmd = TaskEither<T, ZnpCommandError>;
 
@@ -97,8 +298,42 @@ namespace lcl::zigbee::adapter::zstack {
     [[nodiscard]] static EitherCmd<SysOsalNvDeleteResponse> parse(const RawZnpResponse& response);
   };
 
+  struct SysOsalNvItemInitResponse {
+    SysOsalNvItemInitStatus status;
+
+    /**
+     * Whether the item exists now, either because it already did or because it was just created.
+     */
+    [[nodiscard]] bool succeeded() const {
+      return status == SYS_OSAL_NV_ITEM_INIT_ALREADY_EXISTS || status == SYS_OSAL_NV_ITEM_INIT_CREATED;
+    }
+
+    [[nodiscard]] static EitherCmd<SysOsalNvItemInitResponse> parse(const RawZnpResponse& response);
+  };
+
+  /**
+   * The MT subsystems an adapter supports, kept as the bitmask SYS_PING reports them in.
+   */
+  struct ZnpCapabilities {
+    uint16_t bitmask = 0;
+
+    constexpr ZnpCapabilities() = default;
+    constexpr explicit ZnpCapabilities(const uint16_t bitmask) : bitmask(bitmask) {}
+    constexpr ZnpCapabilities(const std::initializer_list<Capability> capabilities) {
+      for (const auto capability : capabilities) {
+        bitmask |= capability;
+      }
+    }
+
+    [[nodiscard]] constexpr bool has(const Capability capability) const {
+      return (bitmask & capability) == capability;
+    }
+
+    constexpr bool operator==(const ZnpCapabilities&) const = default;
+  };
+
   struct SysPingResponse {
-    std::set<Capability> capabilities;
+    ZnpCapabilities capabilities;
     [[nodiscard]] static EitherCmd<SysPingResponse> parse(const RawZnpResponse& response);
   };
 
@@ -210,54 +445,70 @@ namespace lcl::zigbee::adapter::zstack {
     std::array<uint8_t, 32> app_out_cluster_list;
   };
 
+  /**
+   * A 64-bit IEEE (extended) address, held as its integer value so it can key device tables directly. The hex string
+   * is only built when asked for, through {@link toString} or std::format.
+   */
   struct IEEEAddress {
     [[nodiscard]] std::string toString() const;
 
-    explicit IEEEAddress() = default;
-    explicit IEEEAddress(const std::array<uint8_t, 8>& data) {
-      this->data = data;
+    constexpr IEEEAddress() = default;
+    constexpr explicit IEEEAddress(const uint64_t value) : value_(value) {}
 
-      std::ostringstream oss;
-      oss << std::hex << std::setfill('0');
-      for (const auto& byte : data) {
-        oss << std::setw(2) << static_cast<unsigned>(byte);
+    /**
+     * From the address bytes in display order, most significant first.
+     */
+    constexpr explicit IEEEAddress(const std::array<uint8_t, 8>& data) {
+      for (const auto byte : data) {
+        value_ = value_ << 8 | byte;
       }
-      string_representation = oss.str();
     }
+
+    [[nodiscard]] constexpr uint64_t value() const {
+      return value_;
+    }
+
+    constexpr auto operator<=>(const IEEEAddress&) const = default;
   private:
-    std::optional<std::string> string_representation = std::nullopt;
-    std::array<uint8_t, 8> data = {};
+    uint64_t value_ = 0;
   };
 
+  /**
+   * A 16-bit network (short) address; see {@link IEEEAddress}.
+   */
   struct ShortAddress {
     [[nodiscard]] std::string toString() const;
 
-    explicit ShortAddress() = default;
-    explicit ShortAddress(const std::array<uint8_t, 2>& data) {
-      this->data = data;
+    constexpr ShortAddress() = default;
+    constexpr explicit ShortAddress(const uint16_t value) : value_(value) {}
 
-      std::ostringstream oss;
-      oss << std::hex << std::setfill('0');
-      for (const auto& byte : data) {
-        oss << std::setw(2) << static_cast<unsigned>(byte);
-      }
-      string_representation = oss.str();
+    /**
+     * From the address bytes in display order, most significant first.
+     */
+    constexpr explicit ShortAddress(const std::array<uint8_t, 2>& data)
+      : value_(static_cast<uint16_t>(data[0] << 8 | data[1])) {}
+
+    [[nodiscard]] constexpr uint16_t value() const {
+      return value_;
     }
+
+    constexpr auto operator<=>(const ShortAddress&) const = default;
   private:
-    std::optional<std::string> string_representation = std::nullopt;
-    std::array<uint8_t, 2> data = {};
+    uint16_t value_ = 0;
   };
 
+  static_assert(sizeof(IEEEAddress) == 8 && sizeof(ShortAddress) == 2);
+
   struct GetDeviceInfoResponse : StatusableResponse {
     /**
      * IEEE address of the device.
      */
-    IEEEAddress ieee_address = IEEEAddress();
+    IEEEAddress ieee_address;
 
     /**
      * Short address of the device.
      */
-    ShortAddress short_address = ShortAddress();
+    ShortAddress short_address;
 
     /**
      * TODO: Convert to typed?
@@ -271,16 +522,61 @@ namespace lcl::zigbee::adapter::zstack {
      */
     DeviceState device_state;
 
+    /**
+     * The most associated devices a single response can list.
+     */
+    static constexpr std::size_t MAX_ASSOCIATED_DEVICES = (ZNP_MAX_PAYLOAD_LENGTH - 14) / 2;
+
     /**
      * Specifies the number of devices being associated to the target device.
      */
     uint8_t number_of_associated_devices;
 
     /**
-     * Array of 16-bits specifies the network address associated with the device.
+     * Network addresses of the associated devices; only the first {@link number_of_associated_devices} are set.
      */
-    std::vector<uint16_t> associated_devices;
+    std::array<uint16_t, MAX_ASSOCIATED_DEVICES> associated_devices;
+
+    [[nodiscard]] std::span<const uint16_t> associatedDevices() const {
+      return { associated_devices.data(), number_of_associated_devices };
+    }
 
     [[nodiscard]] static EitherCmd<GetDeviceInfoResponse> parse(const RawZnpResponse& response);
   };
 }
+
+template<>
+struct std::hash<lcl::zigbee::adapter::zstack::IEEEAddress> {
+  std::size_t operator()(const lcl::zigbee::adapter::zstack::IEEEAddress &address) const noexcept {
+    return std::hash<uint64_t>{}(address.value());
+  }
+};
+
+template<>
+struct std::hash<lcl::zigbee::adapter::zstack::ShortAddress> {
+  std::size_t operator()(const lcl::zigbee::adapter::zstack::ShortAddress &address) const noexcept {
+    return std::hash<uint16_t>{}(address.value());
+  }
+};
+
+template<>
+struct std::formatter<lcl::zigbee::adapter::zstack::IEEEAddress> {
+  constexpr auto parse(auto &context) {
+    return context.begin();
+  }
+
+  auto format(const lcl::zigbee::adapter::zstack::IEEEAddress &address, auto &context) const {
+    return std::format_to(context.out(), "{:016x}", address.value());
+  }
+};
+
+template<>
+struct std::formatter<lcl::zigbee::adapter::zstack::ShortAddress> {
+  constexpr auto parse(auto &context) {
+    return context.begin();
+  }
+
+  auto format(const lcl::zigbee::adapter::zstack::ShortAddress &address, auto &context) const {
+    return std::format_to(context.out(), "{:04x}", address.value());
+  }
+};
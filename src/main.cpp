@@ -10,7 +10,8 @@ int main(int argc, char const* argv[])
 
   try {
     auto command = cli.ParseArguments(argc, argv);
-    auto result = cli.ExecuteCommand(command, std::cout).await_resume();
+    auto task = cli.ExecuteCommand(command, std::cout);
+    auto result = lcl::async::sync_wait(task);
 
     if (!result.success) {
       std::cerr << "Error: " << result.errorMessage << '\n';
@@ -2,8 +2,12 @@
  * Tags: provider, zigbee, tcp, usb
  */
 #include <iostream>
+#include <optional>
+#include <set>
+#include <stop_token>
 #include <zigbee/adapter/ZStack/ZStackAdapter.hpp>
 
+#include "async/combinators.hpp"
 #include "logger/logger.hpp"
 #include "zigbee/ZigbeeError.hpp"
 #include "zigbee/ZSpec.hpp"
@@ -18,13 +22,49 @@ namespace lcl::zigbee::adapter {
   using namespace zstack;
   using namespace logger;
 
-  ZStackAdapter::ZStackAdapter(const std::string &connection, const ConnectionOptions options = {}): network_processor(connection, options) {
+  ZStackAdapter::ZStackAdapter(const std::string &connection, const ConnectionOptions options = {}): network_processor(connection, options),
+    commissioning_timeout(options.commissioning_timeout),
+    reconcile_commissioning(options.reconcile_commissioning),
+    state_file(options.state_file) {
   }
 
-  TaskErrean<ZStackError> ZStackAdapter::initializeProcessor() {
+  async::Task<bool> ZStackAdapter::restoreFingerprint() {
+    if (!state_file) {
+      co_return false;
+    }
+
+    const auto fingerprint = ZnpFingerprint::load(*state_file);
+    if (!fingerprint) {
+      co_return false;
+    }
+
+    // Two small SREQs instead of the full probe
+    auto [device_info, version_result] = co_await async::when_all(
+      network_processor.getDeviceInfo(),
+      network_processor.getVersion());
+    if (!device_info || !version_result || !fingerprint->matches(device_info->ieee_address, *version_result)) {
+      Logger::info(TAG(), "Adapter fingerprint is stale; probing the adapter");
+      co_return false;
+    }
+
+    capabilities = fingerprint->capabilities;
+    version = *version_result;
+    memory_alignment = fingerprint->memory_alignment;
+    network_processor.primeItemLengths(fingerprint->item_lengths);
+    Logger::info(TAG(), "Restored adapter fingerprint for %s", fingerprint->ieee_address.c_str());
+    co_return true;
+  }
+
+  TaskErrean<ZStackError> ZStackAdapter::probeProcessor() {
     // TODO: Do this a few times
+    // Ping, firmware version, memory alignment and device info don't depend on each other so issue them together
+    auto [ping_response, version_result, nwkkey_response, device_info] = co_await async::when_all(
+      network_processor.ping(),
+      network_processor.getVersion(),
+      network_processor.getMemoryAlignment(),
+      network_processor.getDeviceInfo());
+
     // Ping and capabilities
-    auto ping_response = co_await network_processor.ping();
     if (!ping_response) {
       co_return ZStackError {
         EC_ZSTACK_COMMAND_ERROR,
@@ -33,12 +73,9 @@ namespace lcl::zigbee::adapter {
       };
     }
 
-    for (auto capability: ping_response.value()->capabilities) {
-      capabilities.insert(capability);
-    }
+    capabilities = ping_response.value()->capabilities;
 
     // Grab the firmware version
-    auto version_result = co_await network_processor.getVersion();
     if (!version_result) {
       Logger::debug(TAG(), "Failed to get z-stack firmware version; assuming 1.2");
       version = SysVersionResponse {
@@ -53,7 +90,6 @@ namespace lcl::zigbee::adapter {
     }
 
     // Grab the memory alignment of the adapter
-    auto nwkkey_response = co_await network_processor.getMemoryAlignment();
     if (!nwkkey_response || !nwkkey_response->status) {
       co_return ZStackError {
         EC_ZSTACK_FAILED_TO_GET_MEMORY_ALIGNMENT,
@@ -63,7 +99,48 @@ namespace lcl::zigbee::adapter {
     }
     memory_alignment = nwkkey_response->data;
 
-    const auto commissioning_result = beginCommissioning({
+    if (state_file && device_info && version_result) {
+      // Only items whose size is fixed by the firmware; the fingerprint is dropped when the firmware changes
+      std::map<uint16_t, uint16_t> item_lengths;
+      for (const auto item : { ZCD_NV_NWKKEY, ZCD_NV_NIB }) {
+        if (const auto length = co_await network_processor.getItemLength(item); length && length->length > 0) {
+          item_lengths[item] = length->length;
+        }
+      }
+
+      const ZnpFingerprint fingerprint {
+        device_info->ieee_address.toString(),
+        *version_result,
+        capabilities,
+        *memory_alignment,
+        item_lengths
+      };
+      if (!fingerprint.save(*state_file)) {
+        Logger::warn(TAG(), "Failed to write the adapter fingerprint to %s", state_file->c_str());
+      }
+    }
+
+    co_return true;
+  }
+
+  TaskErrean<ZStackError> ZStackAdapter::initializeProcessor() {
+    if (!co_await restoreFingerprint()) {
+      const auto probe_result = co_await probeProcessor();
+      if (!probe_result) {
+        co_return probe_result;
+      }
+    }
+
+    // Only Z-Stack 3.x is started through BDB commissioning, which is what reports the network coming up. Listen before
+    // commissioning starts so a quick state change isn't missed.
+    const bool bdb_commissioning = std::set<uint8_t>({ZNP_VERSION_ZSTACK_3x0, ZNP_VERSION_ZSTACK_30x}).contains(version->product_id);
+    std::stop_source stop_waiting;
+    std::optional<async::Task<bool>> network_started;
+    if (bdb_commissioning) {
+      network_started.emplace(network_processor.waitForCoordinatorStarted(commissioning_timeout, stop_waiting.get_token()));
+    }
+
+    const auto commissioning_result = co_await beginCommissioning({
       // 0x1A62,
       // 0xDDDDDDDDDDDDDDDD,
       0x1A64,
@@ -73,7 +150,32 @@ namespace lcl::zigbee::adapter {
       {0X01, 0X03, 0X05, 0X07, 0X09, 0X0B, 0X0D, 0X0F, 0X00, 0X02, 0X04, 0X06, 0X08, 0X0A, 0X0C, 0X0D},
       false
     }, true, true);
-    std::this_thread::sleep_for(std::chrono::seconds(10));
+    if (!commissioning_result) {
+      if (network_started) {
+        // Stop listening before returning so the wait can't outlive this call
+        stop_waiting.request_stop();
+        auto &waiting = *network_started;
+        try {
+          co_await waiting;
+        } catch (const async::cancelled_error &) {
+          // The stop requested above, or the wait timing out first
+        }
+      }
+      co_return commissioning_result;
+    }
+
+    if (network_started) {
+      auto &waiting = *network_started;
+      try {
+        if (!co_await waiting) {
+          co_return ZStackError { EC_ZSTACK_COMMISSIONING_FAILED, "The adapter failed to form its network." };
+        }
+      } catch (const async::timeout_error &) {
+        co_return ZStackError { EC_ZSTACK_COMMISSIONING_FAILED, "Timed out waiting for the adapter to form its network." };
+      }
+    } else {
+      Logger::info("USER", "Z-Stack 1.2 doesn't report its network forming; continuing without waiting for it");
+    }
 
     const auto result = network_processor.getActiveEndpoints(0xFFFF, 0xFFFF);
 
@@ -112,19 +214,30 @@ namespace lcl::zigbee::adapter {
       co_return ZStackError { EC_ZSTACK_INVALID_PAN_ID, "PAN ID cannot be 0xFFFF" };
     }
 
-    Logger::info("USER", "Deleting network block information");
-    const auto nib_result = co_await network_processor.deleteNetworkInformationBlock();
-    if (!nib_result || !nib_result->status) {
-      co_return ZStackError { EC_ZSTACK_COMMISSIONING_FAILED, "Failed to clear the NIB", nib_result.error() };
+    // A failed read just means we can't prove the adapter is configured, so fall back to recommissioning
+    bool already_commissioned = false;
+    if (reconcile_commissioning) {
+      const auto match_result = co_await network_processor.networkItemsMatch(network_options);
+      already_commissioned = match_result.valueOrElse(false);
     }
 
-    const auto clear_result = co_await clearAdapter();
-    if (!clear_result) {
-      co_return ZStackError { EC_ZSTACK_COMMISSIONING_FAILED, "Failed to clear the adapter", clear_result };
-    }
+    if (already_commissioned) {
+      Logger::info("USER", "Adapter already configured for this network; skipping recommissioning");
+    } else {
+      Logger::info("USER", "Deleting network block information");
+      const auto nib_result = co_await network_processor.deleteNetworkInformationBlock();
+      if (!nib_result || !nib_result->status) {
+        co_return ZStackError { EC_ZSTACK_COMMISSIONING_FAILED, "Failed to clear the NIB", nib_result.error() };
+      }
+
+      const auto clear_result = co_await clearAdapter();
+      if (!clear_result) {
+        co_return ZStackError { EC_ZSTACK_COMMISSIONING_FAILED, "Failed to clear the adapter", clear_result };
+      }
 
-    const auto update_result = co_await updateCommissioningItems(network_options);
-    if (!update_result) co_return {update_result};
+      const auto update_result = co_await updateCommissioningItems(network_options);
+      if (!update_result) co_return {update_result};
+    }
 
     if (std::set<uint8_t>({ZNP_VERSION_ZSTACK_3x0, ZNP_VERSION_ZSTACK_30x}).contains(version->product_id)) {
       Logger::info("USER", "Setting primary BDB Commissioning channels");
@@ -150,56 +263,61 @@ namespace lcl::zigbee::adapter {
   }
 
   TaskErrean<ZStackError> ZStackAdapter::updateCommissioningItems(const ZnpNetworkOptions &network_options) {
-    Logger::info("USER", "Clearing startup options");
-    const auto startup_result = co_await network_processor.setStartupOptions(ZnpStartupOptions::normal());
+    // The NV items are independent of each other; write them together and check the results in order
+    Logger::info("USER", "Writing commissioning items");
+    const auto [
+      startup_result,
+      logical_type_result,
+      zdo_direct_db_result,
+      channel_list_result,
+      pan_id_result,
+      extended_pan_id_result,
+      aps_use_extended_pan_id_result,
+      enabled_prec_keys_result,
+      preconfigured_keys_result
+    ] = co_await async::when_all(
+      network_processor.setStartupOptions(ZnpStartupOptions::normal()),
+      network_processor.setLogicalType(LOGICAL_TYPE_COORDINATOR),
+      network_processor.setZdoDirectCallback(true),
+      network_processor.setChannelList(toChannelMask(network_options.channel_list)),
+      network_processor.setPanID(network_options.pan_id),
+      network_processor.setExtendedPanID(network_options.extended_pan_id),
+      network_processor.setApsUseExtendedPanID(network_options.extended_pan_id),
+      network_processor.setPreconfiguredKeysEnabled(network_options.network_key_distribute),
+      network_processor.setPreconfiguredKeys(network_options.network_key));
+
     if (!startup_result || !startup_result->status) {
       co_return ZStackError { EC_ZSTACK_COMMISSIONING_FAILED, "Failed to set startup options.", startup_result };
     }
 
-    Logger::info("USER", "Setting the logical type to coordinator");
-    const auto logical_type_result = co_await network_processor.setLogicalType(LOGICAL_TYPE_COORDINATOR);
     if (!logical_type_result || !logical_type_result->status) {
       co_return ZStackError { EC_ZSTACK_COMMISSIONING_FAILED, "Failed to set logical type.", logical_type_result };
     }
 
-    Logger::info("USER", "Enabling ZDO direct callback");
-    const auto zdo_direct_db_result = co_await network_processor.setZdoDirectCallback(true);
     if (!zdo_direct_db_result || !zdo_direct_db_result->status) {
       co_return ZStackError { EC_ZSTACK_COMMISSIONING_FAILED, "Failed to enable the ZDO direct callback.", zdo_direct_db_result };
     }
 
-    Logger::info("USER", "Setting the channel lists");
-    const auto channel_list_result = co_await network_processor.setChannelList(toChannelMask(network_options.channel_list));
     if (!channel_list_result || !channel_list_result->status) {
       co_return ZStackError { EC_ZSTACK_COMMISSIONING_FAILED, "Failed to set the channel list.", channel_list_result };
     }
 
-    Logger::info("USER", "Setting the pan ID");
-    const auto pan_id_result = co_await network_processor.setPanID(network_options.pan_id);
     if (!pan_id_result || !pan_id_result->status) {
       co_return ZStackError { EC_ZSTACK_COMMISSIONING_FAILED, "Failed to set the pan ID.", pan_id_result };
     }
 
-    Logger::info("USER", "Setting the extended pan ID");
-    const auto extended_pan_id_result = co_await network_processor.setExtendedPanID(network_options.extended_pan_id);
     if (!extended_pan_id_result || !extended_pan_id_result->status) {
       co_return ZStackError { EC_ZSTACK_COMMISSIONING_FAILED, "Failed to set the extended pan ID.", extended_pan_id_result };
     }
 
-    Logger::info("USER", "Setting the APS use extended pan ID");
-    const auto aps_use_extended_pan_id_result = co_await network_processor.setApsUseExtendedPanID(network_options.extended_pan_id);
     if (!aps_use_extended_pan_id_result || !aps_use_extended_pan_id_result->status) {
       co_return ZStackError { EC_ZSTACK_COMMISSIONING_FAILED, "Failed to set the APS use extended pan ID.", aps_use_extended_pan_id_result };
     }
 
-    Logger::info("USER", "Enabling preconfigured keys");
-    const auto enabled_prec_keys_result = co_await network_processor.setPreconfiguredKeysEnabled(network_options.network_key_distribute);
     if (!enabled_prec_keys_result || !enabled_prec_keys_result->status) {
       co_return ZStackError { EC_ZSTACK_COMMISSIONING_FAILED, "Failed to enable preconfigured keys.", enabled_prec_keys_result };
     }
 
-    Logger::info("USER", "Setting preconfigured keys");
-    const auto preconfigured_keys_result = co_await network_processor.setPreconfiguredKeys(network_options.network_key);
     if (!preconfigured_keys_result || !preconfigured_keys_result->status) {
       co_return ZStackError { EC_ZSTACK_COMMISSIONING_FAILED, "Failed to set preconfigured keys", preconfigured_keys_result.error() };
     }
@@ -254,12 +372,19 @@ namespace lcl::zigbee::adapter {
       co_return connect_result.value();
     }
 
-    const auto initialize_result = co_await initializeProcessor();
-    if (!initialize_result) {
+    try {
+      const auto initialize_result = co_await initializeProcessor();
+      if (!initialize_result) {
+        co_return AdapterError {
+          EC_ADAPTER_FAILED_TO_START,
+          "Failed to start the z-stack adapter.",
+          initialize_result};
+      }
+    } catch (const async::timeout_error &error) {
       co_return AdapterError {
         EC_ADAPTER_FAILED_TO_START,
-        "Failed to start the z-stack adapter.",
-        initialize_result};
+        std::string("The z-stack adapter stopped responding: ") + error.what()
+      };
     }
 
     co_return true;
@@ -4,14 +4,24 @@
 
 #include "zigbee/adapter/ZStack/ZigbeeNetworkProcessor.hpp"
 
+#include <algorithm>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <mutex>
+#include <ranges>
 #include <regex>
+#include <span>
+#include <stdexcept>
+#include <system_error>
 
 #include "asio/connect.hpp"
+#include "asio/post.hpp"
+#include "asio/write.hpp"
+#include "async/combinators.hpp"
 #include "logger/logger.hpp"
 #include "util/VectorUtil.hpp"
+#include "zigbee/adapter/ZStack/ZnpCommandDescriptors.hpp"
 #include "zigbee/adapter/ZStack/ZnpCommands.hpp"
 
 #define TAG() "ZigbeeNetworkProcessor"
@@ -19,8 +29,53 @@
 namespace lcl::zigbee::adapter::zstack {
   using logger::Logger;
   using async::DeferredTask;
+  using async::LazyTask;
   using async::Task;
 
+  namespace {
+    // How many chunk requests are queued ahead of the wire at once; the SREQ window still writes them one at a time
+    constexpr std::size_t NV_PIPELINE_DEPTH = 4;
+
+    ZnpCommand nvReadCommand(const DeviceConfiguration configuration, const bool extended, const std::size_t offset) {
+      return extended
+        ? sysOsalNvReadExt(configuration, offset)
+        : sysOsalNvRead(configuration, offset);
+    }
+
+    // Single NV items making up the network state, followed by tables whose entries are consecutive item IDs
+    constexpr DeviceConfiguration NETWORK_STATE_ITEMS[] = {
+      ZCD_NV_EXTADDR, ZCD_NV_NIB, ZCD_NV_PAN_ID, ZCD_NV_EXTENDED_PAN_ID, ZCD_NV_APS_USE_EXT_PANID, ZCD_NV_CHANLIST,
+      ZCD_NV_LOGICAL_TYPE, ZCD_NV_PRECFGKEYS, ZCD_NV_PRECFGKEYS_ENABLE, ZCD_NV_NWKKEY, ZCD_NV_NWK_ACTIVE_KEY_INFO,
+      ZCD_NV_NWK_ALTERN_KEY_INFO, ZCD_NV_TRUSTCENTER_ADDR
+    };
+    constexpr std::pair<DeviceConfiguration, DeviceConfiguration> NETWORK_STATE_TABLES[] = {
+      { ZCD_NV_NWK_SEC_MATERIAL_TABLE_START, ZCD_NV_NWK_SEC_MATERIAL_TABLE_END },
+      { ZCD_NV_LEGACY_TCLK_TABLE_START_12, ZCD_NV_LEGACY_TCLK_TABLE_END_12 },
+      { ZCD_NV_APS_LINK_KEY_DATA_START, ZCD_NV_APS_LINK_KEY_DATA_END }
+    };
+
+    // NV item encodings shared by the setters and networkItemsMatch so a read-back compares against exactly what a
+    // write would store
+
+    std::vector<uint8_t> flagItem(const bool enabled) {
+      return { static_cast<uint8_t>(enabled ? 0x01 : 0x00) };
+    }
+
+    std::vector<uint8_t> panIdItem(const uint16_t pan_id) {
+      return { TO_VECTOR_ARG_LITTLE_ENDIAN_U16(pan_id) };
+    }
+
+    std::vector<uint8_t> extendedPanIdItem(const uint64_t extended_pan_id) {
+      return { TO_VECTOR_ARG_LITTLE_ENDIAN_U64(extended_pan_id) };
+    }
+
+    std::vector<uint8_t> channelListItem(const uint32_t bitmask) {
+      auto channel_buffer = std::vector<uint8_t>(4);
+      SET_VECTOR_AT_LITTLE_ENDIAN_U32(channel_buffer, 0, bitmask);
+      return channel_buffer;
+    }
+  }
+
   ConnectionUri ConnectionUri::parse(const std::string &connection_string) {
     const std::regex tcp_regex(R"(tcp://([^:]+):(\d+))");
     const std::regex usb_regex(R"(usb://(/dev/.*))");
@@ -39,7 +94,12 @@ namespace lcl::zigbee::adapter::zstack {
   ZigbeeNetworkProcessor::ZigbeeNetworkProcessor(
     const std::string &connection_string,
     const ConnectionOptions connection_options
-  ): connection_uri(ConnectionUri::parse(connection_string)), connection_options(connection_options) { }
+  ): connection_uri(ConnectionUri::parse(connection_string)), connection_options(connection_options) {
+    if (connection_options.nv_cache) {
+      nv_cache.emplace(response_executor);
+    }
+    request_deadlines->processor = this;
+  }
 
   ZigbeeNetworkProcessor::~ZigbeeNetworkProcessor() {
     io_context.stop();
@@ -52,6 +112,37 @@ namespace lcl::zigbee::adapter::zstack {
     if (read_thread.joinable()) {
       read_thread.join();
     }
+
+    // Waits out any deadline callback already expiring a request; none can start once processor is cleared
+    std::set<async::timer_service::timer> armed;
+    {
+      std::lock_guard lock(request_deadlines->mutex);
+      request_deadlines->processor = nullptr;
+      armed.swap(request_deadlines->armed);
+    }
+    for (const auto &deadline : armed) {
+      async::get_timer_service().cancel(deadline);
+    }
+
+    // Every queued request also awaits its response, so this rejects those too
+    std::vector<DeferredTask<RawZnpResponse>::resolver> abandoned;
+    {
+      std::lock_guard lock(response_mutex);
+      for (auto &[response_key, pending] : pending_requests) {
+        std::ranges::move(pending.waiters, std::back_inserter(abandoned));
+      }
+      pending_requests.clear();
+      sreq_window = {};
+      areq_windows.clear();
+    }
+    for (const auto &resolver : abandoned) {
+      resolver.reject(std::make_exception_ptr(async::cancelled_error("The ZNP processor was destroyed")));
+    }
+
+    // The rejected awaiters resume on the io_context; run them now rather than dropping them with it. Anything they
+    // send fails straight away on the closed transport.
+    io_context.restart();
+    io_context.poll();
   }
 
   void ZigbeeNetworkProcessor::configureUsbDevice() {
@@ -115,60 +206,79 @@ namespace lcl::zigbee::adapter::zstack {
     });
   }
 
-  std::optional<RawZnpResponse> parseResponse(std::vector<uint8_t> &buffer) {
-    if (buffer.empty()) {
-      return std::nullopt;
-    }
-
-    if (buffer[0] != SOF) {
-      // TODO
-      throw std::invalid_argument("Invalid response");
-    }
-
-    // Not enough bytes
-    if (buffer.size() < 4) {
-      return std::nullopt;
-    }
-
-    const auto length = buffer[1];
-    if (buffer.size() < 4 + length) {
-      return std::nullopt;
-    }
+  void ZigbeeNetworkProcessor::handleRead(std::span<const uint8_t> data) {
+    std::vector<std::pair<DeferredTask<RawZnpResponse>::resolver, RawZnpResponse>> completed;
+    std::vector<DeferredTask<RawZnpResponse>::resolver> rejected;
+    std::vector<QueuedRequest> admitted;
+    std::vector<RawZnpResponse> unsolicited;
+    {
+      std::lock_guard lock(response_mutex);
+      if (Logger::currentLogLevel() == logger::LogLevel::TRACE) {
+        Logger::trace(TAG(), "Reading [%zu]", data.size());
+        Logger::trace(TAG(), "%s | %s", util::toHexString(data), util::toDecimalString(data));
+      }
+      const auto frames_dropped = frame_decoder.statistics().framesDropped();
+      while (!data.empty()) {
+        data = data.subspan(frame_decoder.write(data));
 
-    const auto type = static_cast<Type>(buffer[2] >> 5);
-    const auto subsystem = static_cast<Subsystem>(0x1F & buffer[2]);
-    const auto command_id = static_cast<MtCommandId>(buffer[3]);
-    const auto data = std::vector(buffer.begin() + 4, buffer.begin() + 4 + length);
+        auto frame = frame_decoder.next();
+        while (frame.has_value()) {
+          if (Logger::currentLogLevel() == logger::LogLevel::TRACE) {
+            Logger::trace(TAG(), "<<< FRAME: %02X, %02X, %02X, %s", frame->command, frame->subsystem, frame->type, util::toHexString(frame->payload));
+          }
 
-    buffer.erase(buffer.begin(), buffer.begin() + 4 + length + 1);
+          const ZnpResponseKey response_key { frame->subsystem, frame->command, frame->type };
+          if (const auto pending = pending_requests.find(response_key); pending != pending_requests.end()) {
+            auto resolver = std::move(pending->second.waiters.front());
+            pending->second.waiters.pop_front();
+            const auto truncated = frame->payload.size() < pending->second.minimum_length;
+            if (pending->second.waiters.empty()) {
+              pending_requests.erase(pending);
+            }
+            if (truncated) {
+              Logger::warn(TAG(), "Truncated response %02X %02X (%zu bytes)", frame->subsystem, frame->command, frame->payload.size());
+              rejected.push_back(std::move(resolver));
+            } else {
+              completed.emplace_back(std::move(resolver), frame->materialize());
+            }
 
-    // TODO: Verify checksum
-    // const auto checksum = (*buffer)[4 + length];
+            if (auto next = releaseInFlight(response_key); next.has_value()) {
+              admitted.push_back(std::move(*next));
+            }
+          } else if (frame->payload.size() < minimumCallbackLength(frame->subsystem, frame->command)) {
+            Logger::warn(TAG(), "Dropped truncated callback %02X %02X (%zu bytes)", frame->subsystem, frame->command, frame->payload.size());
+          } else {
+            unsolicited.push_back(frame->materialize());
+          }
+          frame = frame_decoder.next();
+        }
+      }
 
-    Logger::trace(TAG(), "<<< FRAME: %02X, %02X, %02X, %s", command_id, subsystem, type, util::toHexString(data), util::toDecimalString(data));
+      if (const auto dropped = frame_decoder.statistics().framesDropped() - frames_dropped; dropped > 0) {
+        Logger::warn(TAG(), "Dropped %llu corrupt frame(s)", static_cast<unsigned long long>(dropped));
+      }
+    }
 
-    return RawZnpResponse { command_id, subsystem, type, data };
-  }
+    // Queue writes outside the lock; the next requests' responses are read on this thread
+    for (auto &request : admitted) {
+      dispatchRequest(std::move(request));
+    }
 
-  void ZigbeeNetworkProcessor::handleRead(const std::array<uint8_t, 256> &buffer, const uint8_t size, std::vector<uint8_t> &pending_buffer) {
-    std::lock_guard lock(response_mutex);
-    if (Logger::currentLogLevel() == logger::LogLevel::TRACE) {
-      Logger::trace(TAG(), "Reading [%d]", size);
-      Logger::trace(TAG(), "%s | %s", util::toHexString(buffer, size), util::toDecimalString(buffer, size));
+    // Awaiters resume inline on this thread and may send their next request, so this must also be outside the lock
+    for (auto &[resolver, response] : completed) {
+      resolver.resolve(std::move(response));
     }
-    if (size <= 1) return;
-    for (auto it = buffer.begin(); it < buffer.begin() + size; ++it) {
-      pending_buffer.push_back(*it);
+    for (const auto &resolver : rejected) {
+      resolver.reject(std::make_exception_ptr(std::length_error("Truncated ZNP response")));
     }
 
-    auto response = parseResponse(pending_buffer);
-    while (response.has_value()) {
-      responses.push_back(*response);
-      response = parseResponse(pending_buffer);
+    for (const auto &frame : unsolicited) {
+      if (!dispatcher.dispatch(frame)) {
+        Logger::debug(TAG(), "Unhandled frame %02X %02X", frame.subsystem, frame.command);
+      }
     }
   }
 
-  auto pending_buffer = std::vector<uint8_t>(0);
   void ZigbeeNetworkProcessor::asyncRead() {
     auto buffer = std::make_shared<std::array<uint8_t, 256>>();
     if (connection_uri.connection_type == CONNECTION_TYPE_TCP) {
@@ -176,7 +286,7 @@ namespace lcl::zigbee::adapter::zstack {
           asio::buffer(*buffer),
           [this, buffer](const asio::error_code& ec, const std::size_t bytes_transferred) {
             if (!ec) {
-              handleRead(*buffer, bytes_transferred, pending_buffer);
+              handleRead(std::span(buffer->data(), bytes_transferred));
               asyncRead();
             } else if (ec != asio::error::operation_aborted) {
               // TODO
@@ -187,7 +297,7 @@ namespace lcl::zigbee::adapter::zstack {
           asio::buffer(*buffer),
           [this, buffer](const asio::error_code& ec, const std::size_t bytes_transferred) {
             if (!ec) {
-              handleRead(*buffer, bytes_transferred, pending_buffer);
+              handleRead(std::span(buffer->data(), bytes_transferred));
               asyncRead();
             } else if (ec != asio::error::operation_aborted) {
               // TODO
@@ -196,64 +306,206 @@ namespace lcl::zigbee::adapter::zstack {
     }
   }
 
-  Task<RawZnpResponse> ZigbeeNetworkProcessor::sendRequest(const ZnpCommand& command) {
-    // Create the buffer of data
-    // TODO: Length
-    std::vector<uint8_t> frame {
-      SOF,
-      static_cast<uint8_t>(command.data.empty() ? 0 : command.data.size()),
-      static_cast<uint8_t>((command.type << 5 & 0xE0) | (command.subsystem & 0x1F)),
-      command.commandId
-    };
+  ZnpFrameStatistics ZigbeeNetworkProcessor::frameStatistics() const {
+    std::lock_guard lock(response_mutex);
+    return frame_decoder.statistics();
+  }
+
+  void ZigbeeNetworkProcessor::setAreqInFlightLimit(const Subsystem subsystem, const uint8_t limit) {
+    std::lock_guard lock(response_mutex);
+    areq_windows[subsystem].limit = std::max<uint8_t>(limit, 1);
+  }
 
-    if (!command.data.empty()) {
-      frame.insert(frame.end(), command.data.begin(), command.data.end());
+  ZigbeeNetworkProcessor::InFlightWindow &ZigbeeNetworkProcessor::inFlightWindow(const ZnpResponseKey &response_key) {
+    if (response_key.type == SRSP) {
+      return sreq_window;
     }
+    return areq_windows[response_key.subsystem];
+  }
 
-    uint8_t checksum = 0;
-    for (std::vector<uint8_t>::size_type i = 1; i < frame.size(); i++) {
-      checksum ^= frame[i];
+  std::optional<ZigbeeNetworkProcessor::QueuedRequest> ZigbeeNetworkProcessor::releaseInFlight(const ZnpResponseKey &response_key) {
+    auto &window = inFlightWindow(response_key);
+    if (window.queued.empty()) {
+      if (window.in_flight > 0) window.in_flight--;
+      return std::nullopt;
     }
-    frame.push_back(checksum);
 
-    if (command.commandId == SYS_RESET_REQ) {
+    // Hand the slot straight to the next queued request
+    auto next = std::move(window.queued.front());
+    window.queued.pop_front();
+    return next;
+  }
+
+  void ZigbeeNetworkProcessor::scheduleRequest(QueuedRequest request) {
+    {
       std::lock_guard lock(response_mutex);
-      responses.clear();
+      // Register interest in the response before writing so it can't arrive unobserved
+      auto &pending = pending_requests[request.response_key];
+      pending.minimum_length = request.minimum_response_length;
+      pending.waiters.push_back(request.resolver);
+
+      auto &window = inFlightWindow(request.response_key);
+      if (window.in_flight >= window.limit) {
+        window.queued.push_back(std::move(request));
+        return;
+      }
+      window.in_flight++;
     }
 
-    try {
-      switch (connection_uri.connection_type) {
-        case CONNECTION_TYPE_TCP:
-          socket->write_some(asio::buffer(frame));
-          break;
-        case CONNECTION_TYPE_USB:
-          if (Logger::currentLogLevel() == logger::LogLevel::TRACE) {
-            Logger::trace(TAG(), "Writing: ");
-            Logger::trace(TAG(), "%s | %s", util::toHexString(frame), util::toDecimalString(frame));
-          }
-          serial_port->write_some(asio::buffer(frame));
-          break;
+    dispatchRequest(std::move(request));
+  }
+
+  void ZigbeeNetworkProcessor::dispatchRequest(QueuedRequest request) {
+    {
+      std::lock_guard lock(write_mutex);
+      write_queue.push_back(std::move(request));
+      if (std::exchange(write_in_progress, true)) {
+        // Picked up by the flush already running
+        return;
       }
+    }
 
-      while (true) {
-        {
-          std::lock_guard lock(response_mutex);
-          if (!responses.empty()) {
-            auto index = 0;
-            for (const auto& r: responses) {
-              if ((r.command == command.commandId && command.type == SREQ && r.type == SRSP)
-                || (r.command == command.responseId && command.type == AREQ && r.type == AREQ)) {
-                RawZnpResponse response = r;
-                responses.erase(responses.begin() + index);
-                co_return response;
-              }
-              index += 1;
-            }
-          }
+    // The transport is only touched from the io_context thread, alongside the pending read
+    asio::post(io_context, [this] { flushWrites(); });
+  }
+
+  void ZigbeeNetworkProcessor::flushWrites() {
+    {
+      std::lock_guard lock(write_mutex);
+      if (write_queue.empty()) {
+        write_in_progress = false;
+        return;
+      }
+      // The cleared batch hands its capacity back to the queue
+      write_batch.swap(write_queue);
+    }
+
+    write_buffers.clear();
+    for (const auto &request : write_batch) {
+      if (Logger::currentLogLevel() == logger::LogLevel::TRACE) {
+        Logger::trace(TAG(), "Writing: ");
+        Logger::trace(TAG(), "%s | %s", util::toHexString(request.frame.view()), util::toDecimalString(request.frame.view()));
+      }
+      write_buffers.push_back(asio::buffer(request.frame.bytes.data(), request.frame.size));
+    }
+
+    // async_write keeps going until every byte is out, so short writes can't truncate a frame
+    auto on_written = [this](const asio::error_code &ec, std::size_t) {
+      if (ec) {
+        const auto error = std::make_exception_ptr(std::system_error(ec));
+        for (auto &request : write_batch) {
+          failWrite(std::move(request), error);
         }
-        co_await async::yield();
       }
-    } catch (const std::exception&) {
+      write_batch.clear();
+      flushWrites();
+    };
+    // A span rather than the vector itself, which async_write would copy into its operation
+    const std::span<const asio::const_buffer> buffers(write_buffers);
+    if (connection_uri.connection_type == CONNECTION_TYPE_TCP) {
+      asio::async_write(*socket, buffers, std::move(on_written));
+    } else {
+      asio::async_write(*serial_port, buffers, std::move(on_written));
+    }
+  }
+
+  void ZigbeeNetworkProcessor::failWrite(QueuedRequest request, const std::exception_ptr error) {
+    std::optional<QueuedRequest> next;
+    {
+      std::lock_guard lock(response_mutex);
+      if (!removePendingRequest(request.response_key, request.resolver)) {
+        // Already expired, which released the slot
+        return;
+      }
+      next = releaseInFlight(request.response_key);
+    }
+
+    request.resolver.reject(error);
+    if (next.has_value()) {
+      dispatchRequest(std::move(*next));
+    }
+  }
+
+  bool ZigbeeNetworkProcessor::removePendingRequest(
+    const ZnpResponseKey &response_key,
+    const DeferredTask<RawZnpResponse>::resolver &resolver
+  ) {
+    const auto pending = pending_requests.find(response_key);
+    if (pending == pending_requests.end()) {
+      return false;
+    }
+
+    const auto removed = std::erase_if(pending->second.waiters, [&resolver](const auto &waiting) {
+      return waiting.promise_ == resolver.promise_;
+    });
+    if (pending->second.waiters.empty()) {
+      pending_requests.erase(pending);
+    }
+    return removed > 0;
+  }
+
+  void ZigbeeNetworkProcessor::expireRequest(
+    const ZnpResponseKey &response_key,
+    DeferredTask<RawZnpResponse>::resolver resolver
+  ) {
+    std::optional<QueuedRequest> next;
+    {
+      std::lock_guard lock(response_mutex);
+      if (!removePendingRequest(response_key, resolver)) {
+        return;
+      }
+
+      // A request still queued behind its window never took a slot
+      const auto dequeued = std::erase_if(inFlightWindow(response_key).queued, [&resolver](const auto &queued) {
+        return queued.resolver.promise_ == resolver.promise_;
+      });
+      if (dequeued == 0) {
+        next = releaseInFlight(response_key);
+      }
+    }
+
+    Logger::warn(TAG(), "Timed out waiting for %02X %02X", response_key.subsystem, response_key.command);
+    resolver.reject(async::timeout_error("Timed out waiting for a ZNP response"));
+
+    if (next.has_value()) {
+      dispatchRequest(std::move(*next));
+    }
+  }
+
+  LazyTask<RawZnpResponse> ZigbeeNetworkProcessor::sendRequest(
+    const ZnpCommand& command,
+    const std::optional<std::chrono::milliseconds> timeout
+  ) {
+    DeferredTask<RawZnpResponse> response { response_executor };
+    const auto response_key = ZnpResponseKey::forRequest(command);
+    auto &timers = async::get_timer_service();
+    // Held by the frame so the deadline can be disarmed even if the processor is destroyed before the response
+    const auto deadlines = request_deadlines;
+    const auto deadline = timers.schedule_after(
+      timeout.value_or(connection_options.request_timeout),
+      [deadlines, response_key, resolver = response.get_resolver()] {
+        std::lock_guard lock(deadlines->mutex);
+        if (deadlines->processor != nullptr) {
+          deadlines->processor->expireRequest(response_key, resolver);
+        }
+      });
+    {
+      std::lock_guard lock(deadlines->mutex);
+      deadlines->armed.insert(deadline);
+    }
+    scheduleRequest({ command.frame(), response_key, response.get_resolver(), command.minimumResponseLength });
+
+    const auto disarm = [&timers, &deadlines, &deadline] {
+      timers.cancel(deadline);
+      std::lock_guard lock(deadlines->mutex);
+      deadlines->armed.erase(deadline);
+    };
+    try {
+      auto result = co_await response;
+      disarm();
+      co_return result;
+    } catch (...) {
+      disarm();
       throw;
     }
   }
@@ -271,9 +523,12 @@ namespace lcl::zigbee::adapter::zstack {
       total_length,
       begin,
       end));
-    const auto parsed_result = StatusableResponse::parse(result);
-    if (!parsed_result || !parsed_result->status) {
-      co_return EitherCmd<SysOsalNvReadResponse<std::vector<uint8_t>>>::error({
+    if (nv_cache) {
+      nv_cache->invalidate(configuration);
+    }
+    const auto parsed_result = SysOsalNvItemInitResponse::parse(result);
+    if (!parsed_result || !parsed_result->succeeded()) {
+      co_return EitherCmd<StatusableResponse>::error({
         SYS_OSAL_NV_ITEM_INIT,
         "Failed to init data for configuration " + std::to_string(configuration),
         parsed_result
@@ -284,58 +539,164 @@ namespace lcl::zigbee::adapter::zstack {
     co_return StatusableResponse::success();
   }
 
+  Task<std::vector<RawZnpResponse>> ZigbeeNetworkProcessor::sendPipelined(const std::vector<ZnpCommand> &commands) {
+    co_return co_await async::for_each_async(commands, NV_PIPELINE_DEPTH, [this](const ZnpCommand &command) -> Task<RawZnpResponse> {
+      co_return co_await sendRequest(command);
+    });
+  }
+
+  Task<RawZnpResponse> ZigbeeNetworkProcessor::readItemChunk(
+    const DeviceConfiguration configuration,
+    const bool extended,
+    const std::size_t offset
+  ) {
+    co_return co_await sendRequest(nvReadCommand(configuration, extended, offset));
+  }
+
+  Task<bool> ZigbeeNetworkProcessor::supportsExtendedNv() {
+    const auto version_result = co_await getVersion();
+    co_return version_result
+      && std::set<uint8_t>({ZNP_VERSION_ZSTACK_3x0, ZNP_VERSION_ZSTACK_30x}).contains(version_result->product_id);
+  }
+
   TaskEitherCmd<StatusableResponse> ZigbeeNetworkProcessor::writeItem(
     const DeviceConfiguration configuration,
     const std::vector<uint8_t> &buffer,
-    const bool auto_initialize
+    const bool auto_initialize,
+    const bool verify
   ) {
     Logger::debug(TAG(), "Writing NV Item [" + std::to_string(configuration) + "]");
+    const auto started = std::chrono::steady_clock::now();
     auto length_result = co_await getItemLength(configuration);
     if (!length_result) {
-      co_return EitherCmd<SysOsalNvReadResponse<std::vector<uint8_t>>>::error({
+      co_return EitherCmd<StatusableResponse>::error({
         SYS_OSAL_NV_LENGTH,
         "Failed to get length of configuration " + std::to_string(configuration),
         length_result
       });
     }
 
-    Logger::trace(TAG(), "[Send]: SYS_OSAL_NV_WRITE_EXT >>>");
-    auto bytes_remaining = buffer.size();
-    if (const auto exists = length_result->length > 0; !exists) {
+    if (nv_cache) {
+      if (length_result->length == buffer.size() && nv_cache->contents(configuration) == buffer) {
+        Logger::debug(TAG(), "NV Item [" + std::to_string(configuration) + "] is unchanged; skipping write");
+        co_return StatusableResponse::success();
+      }
+      // Reads overlapping the write mustn't cache what was there before
+      nv_cache->invalidate(configuration);
+    }
+
+    const bool extended = co_await supportsExtendedNv();
+    const std::size_t chunk_length = extended ? ZNP_NV_WRITE_EXT_CHUNK_LENGTH : ZNP_NV_WRITE_CHUNK_LENGTH;
+
+    // A missing item is created by SYS_OSAL_NV_ITEM_INIT, which carries its first bytes
+    const auto exists = length_result->length > 0;
+    const std::size_t offset = exists ? 0 : std::min(buffer.size(), ZNP_NV_ITEM_INIT_CHUNK_LENGTH);
+    const auto ranges = nvChunks(offset, buffer.size(), chunk_length);
+    if (!extended && !nvChunksFitShortOffsets(ranges)) {
+      co_return EitherCmd<StatusableResponse>::error({
+        SYS_OSAL_NV_WRITE,
+        "NV Item [" + std::to_string(configuration) + "] is too large to write without SYS_OSAL_NV_WRITE_EXT"
+      });
+    }
+
+    if (!exists) {
       if (!auto_initialize) {
-        throw "Cannot write NV memory item which does not exist";
+        co_return EitherCmd<StatusableResponse>::error({
+          extended ? SYS_OSAL_NV_WRITE_EXT : SYS_OSAL_NV_WRITE,
+          "Cannot write NV Item [" + std::to_string(configuration) + "] which does not exist"
+        });
       }
       Logger::debug(TAG(), "Item doesn't exist; initializing");
-      const uint8_t initial_length = buffer.size() > 240 ? 240 : buffer.size();
-      const auto init_result = co_await initializeItem(configuration, buffer.size(), buffer.begin(), buffer.begin() + initial_length);
+      const auto init_result = co_await initializeItem(configuration, buffer.size(), buffer.begin(), buffer.begin() + offset);
       if (!init_result || !init_result->status) {
         co_return init_result;
       }
-      bytes_remaining -= initial_length;
     }
 
-    while (bytes_remaining > 0) {
-      const uint16_t write_length = bytes_remaining > 240 ? 240 : bytes_remaining;
-      const uint16_t offset = buffer.size() - bytes_remaining;
-      const auto write_result = co_await sendRequest(sysOsalNvWriteExt(configuration, offset, buffer.begin() + offset, buffer.begin() + write_length));
-      Logger::trace(TAG(), "Writing " + std::to_string(write_length) + " bytes");
-      const auto parsed_result = StatusableResponse::parse(write_result);
+    // Every chunk is framed up front and queued so each is written the moment the previous SRSP arrives
+    std::vector<ZnpCommand> chunks;
+    chunks.reserve(ranges.size());
+    for (const auto &[begin, end] : ranges) {
+      chunks.push_back(extended
+        ? sysOsalNvWriteExt(configuration, begin, buffer.begin() + begin, buffer.begin() + end)
+        : sysOsalNvWrite(configuration, begin, buffer.begin() + begin, buffer.begin() + end));
+    }
+
+    const std::string command_name = extended ? "SYS_OSAL_NV_WRITE_EXT" : "SYS_OSAL_NV_WRITE";
+    Logger::trace(TAG(), "[Send]: " + command_name + " x" + std::to_string(chunks.size()) + " >>>");
+    const auto responses = co_await sendPipelined(chunks);
+    Logger::trace(TAG(), "[Recv]: " + command_name + " <<<");
+    for (const auto &response : responses) {
+      const auto parsed_result = StatusableResponse::parse(response);
       if (!parsed_result || !parsed_result->status) {
         co_return parsed_result;
       }
+    }
 
-      bytes_remaining -= write_length;
+    {
+      std::lock_guard lock(nv_statistics_mutex);
+      nv_statistics.bytes_written += buffer.size();
+      nv_statistics.chunks_written += chunks.size();
+      nv_statistics.write_time += std::chrono::steady_clock::now() - started;
+    }
+
+    if (verify) {
+      // The item was invalidated above, so this goes to the adapter and caches what it actually holds
+      const auto read_back = co_await readItem(configuration);
+      if (!read_back || read_back->data != buffer) {
+        co_return EitherCmd<StatusableResponse>::error({
+          extended ? SYS_OSAL_NV_READ_EXT : SYS_OSAL_NV_READ,
+          "NV Item [" + std::to_string(configuration) + "] didn't read back as written"
+        });
+      }
+    } else if (nv_cache) {
+      nv_cache->storeContents(configuration, buffer);
     }
-    Logger::trace(TAG(), "[Send]: SYS_OSAL_NV_WRITE_EXT <<<");
 
     co_return StatusableResponse::success();
   }
 
   TaskEitherCmd<SysOsalNvReadResponse<std::vector<uint8_t>>> ZigbeeNetworkProcessor::readItem(
+    const DeviceConfiguration configuration
+  ) {
+    if (!nv_cache) {
+      co_return co_await readItemFromAdapter(configuration);
+    }
+
+    if (auto contents = nv_cache->contents(configuration)) {
+      co_return EitherCmd<SysOsalNvReadResponse<std::vector<uint8_t>>>::value({
+        {true},
+        std::move(*contents)
+      });
+    }
+
+    auto ticket = nv_cache->beginRead(configuration);
+    if (ticket.in_flight) {
+      Logger::debug(TAG(), "Joining in-flight read of NV Item [" + std::to_string(configuration) + "]");
+      co_return co_await *ticket.in_flight;
+    }
+
+    try {
+      auto result = co_await readItemFromAdapter(configuration);
+      nv_cache->finishRead(configuration, ticket.generation, result);
+      co_return result;
+    } catch (...) {
+      nv_cache->abandonRead(configuration, std::current_exception());
+      throw;
+    }
+  }
+
+  TaskEitherCmd<SysOsalNvReadResponse<std::vector<uint8_t>>> ZigbeeNetworkProcessor::readItemFromAdapter(
     DeviceConfiguration configuration
   ) {
     Logger::debug(TAG(), "Reading NV Item [" + std::to_string(configuration) + "]");
-    const auto length_result = co_await getItemLength(configuration);
+    const auto started = std::chrono::steady_clock::now();
+    const bool extended = co_await supportsExtendedNv();
+
+    // The first chunk is queued right behind the length query; its size tells us how much the adapter returns per read
+    auto length_task = getItemLength(configuration);
+    auto first_chunk_task = readItemChunk(configuration, extended, 0);
+    auto [length_result, first_response] = co_await async::when_all(std::move(length_task), std::move(first_chunk_task));
     if (!length_result) {
       co_return EitherCmd<SysOsalNvReadResponse<std::vector<uint8_t>>>::error({
         SYS_OSAL_NV_LENGTH,
@@ -348,26 +709,56 @@ namespace lcl::zigbee::adapter::zstack {
       co_return EitherCmd<SysOsalNvReadResponse<std::vector<uint8_t>>>::value({});
     }
 
-    Logger::trace(TAG(), "[Send]: SYS_OSAL_NV_READ_EXT >>>");
-    const auto length = length_result->length;
+    const auto first_result = SysOsalNvReadResponse<std::vector<uint8_t>>::parse(first_response);
+    if (!first_result || !first_result->status || first_result->data.empty()) {
+      co_return EitherCmd<SysOsalNvReadResponse<std::vector<uint8_t>>>::error({
+        extended ? SYS_OSAL_NV_READ_EXT : SYS_OSAL_NV_READ,
+        "Failed to read configuration " + std::to_string(configuration)
+      });
+    }
+
+    const std::size_t length = length_result->length;
+    const std::size_t chunk_length = first_result->data.size();
+    const auto ranges = nvChunks(chunk_length, length, chunk_length);
+    if (!extended && !nvChunksFitShortOffsets(ranges)) {
+      co_return EitherCmd<SysOsalNvReadResponse<std::vector<uint8_t>>>::error({
+        SYS_OSAL_NV_READ,
+        "NV Item [" + std::to_string(configuration) + "] is too large to read without SYS_OSAL_NV_READ_EXT"
+      });
+    }
+
     auto buffer = std::vector<uint8_t>(length);
-    std::vector<uint8_t>::size_type offset = 0;
-    while (offset < length) {
-      const auto result = co_await sendRequest(sysOsalNvRead(
-        configuration,
-        offset));
-      const auto parsed_result = SysOsalNvReadResponse<std::vector<uint8_t>>::parse(result);
-      if (!parsed_result || !parsed_result->status) {
+    std::ranges::copy(first_result->data | std::views::take(length), buffer.begin());
+
+    std::vector<ZnpCommand> chunks;
+    chunks.reserve(ranges.size());
+    for (const auto &[begin, end] : ranges) {
+      chunks.push_back(nvReadCommand(configuration, extended, begin));
+    }
+
+    const std::string command_name = extended ? "SYS_OSAL_NV_READ_EXT" : "SYS_OSAL_NV_READ";
+    Logger::trace(TAG(), "[Send]: " + command_name + " x" + std::to_string(chunks.size() + 1) + " >>>");
+    const auto responses = co_await sendPipelined(chunks);
+    Logger::trace(TAG(), "[Recv]: " + command_name + " <<<");
+    for (std::size_t i = 0; i < responses.size(); i++) {
+      const auto parsed_result = SysOsalNvReadResponse<std::vector<uint8_t>>::parse(responses[i]);
+      const auto [offset, end] = ranges[i];
+      // Anything but a full chunk (or the exact remainder) would leave part of the item zero-filled
+      if (!parsed_result || !parsed_result->status || parsed_result->data.size() != end - offset) {
         co_return EitherCmd<SysOsalNvReadResponse<std::vector<uint8_t>>>::error({
-          SYS_OSAL_NV_LENGTH,
-          ("Failed to read chunk of data for configuration " + std::to_string(configuration)),
-          length_result
+          extended ? SYS_OSAL_NV_READ_EXT : SYS_OSAL_NV_READ,
+          "Failed to read chunk of data for configuration " + std::to_string(configuration)
         });
       }
       std::ranges::copy(parsed_result->data, buffer.begin() + offset);
-      offset += parsed_result->data.size();
     }
-    Logger::trace(TAG(), "[Send]: SYS_OSAL_NV_READ_EXT <<<");
+
+    {
+      std::lock_guard lock(nv_statistics_mutex);
+      nv_statistics.bytes_read += length;
+      nv_statistics.chunks_read += chunks.size() + 1;
+      nv_statistics.read_time += std::chrono::steady_clock::now() - started;
+    }
 
     co_return EitherCmd<SysOsalNvReadResponse<std::vector<uint8_t>>>::value({
       {true},
@@ -375,11 +766,128 @@ namespace lcl::zigbee::adapter::zstack {
     });
   }
 
+  TaskEitherCmd<ZnpNvSnapshot> ZigbeeNetworkProcessor::backupNetworkState() {
+    Logger::info(TAG(), "Backing up network state");
+    const auto version_result = co_await getVersion();
+    if (!version_result) {
+      co_return EitherCmd<ZnpNvSnapshot>::error({ SYS_VERSION, "Failed to read the adapter version", version_result });
+    }
+
+    ZnpNvSnapshot snapshot;
+    snapshot.product_id = version_result->product_id;
+    const bool extended = co_await supportsExtendedNv();
+
+    // Stores the item if it exists, returning whether it did
+    const auto backupItem = [this, &snapshot, extended](const DeviceConfiguration item) -> TaskEitherCmd<bool> {
+      const auto read_result = co_await readItem(item);
+      if (!read_result) {
+        co_return EitherCmd<bool>::error({
+          extended ? SYS_OSAL_NV_READ_EXT : SYS_OSAL_NV_READ,
+          "Failed to back up NV Item [" + std::to_string(item) + "]",
+          read_result
+        });
+      }
+      if (read_result->data.empty()) {
+        co_return EitherCmd<bool>::value(false);
+      }
+      snapshot.items[item] = read_result->data;
+      co_return EitherCmd<bool>::value(true);
+    };
+
+    for (const auto item : NETWORK_STATE_ITEMS) {
+      const auto result = co_await backupItem(item);
+      if (!result) {
+        co_return EitherCmd<ZnpNvSnapshot>::error(result.errorOrThrow());
+      }
+    }
+
+    for (const auto &[first, last] : NETWORK_STATE_TABLES) {
+      for (uint16_t item = first; item <= last; item++) {
+        const auto result = co_await backupItem(static_cast<DeviceConfiguration>(item));
+        if (!result) {
+          co_return EitherCmd<ZnpNvSnapshot>::error(result.errorOrThrow());
+        }
+        if (!*result) {
+          break;
+        }
+      }
+    }
+
+    Logger::info(TAG(), "Backed up %zu NV items", snapshot.items.size());
+    co_return EitherCmd<ZnpNvSnapshot>::value(std::move(snapshot));
+  }
+
+  TaskEitherCmd<StatusableResponse> ZigbeeNetworkProcessor::restoreNetworkState(const ZnpNvSnapshot &snapshot) {
+    Logger::info(TAG(), "Restoring %zu NV items", snapshot.items.size());
+    const auto version_result = co_await getVersion();
+    if (!version_result) {
+      co_return EitherCmd<StatusableResponse>::error({ SYS_VERSION, "Failed to read the adapter version", version_result });
+    }
+    if (version_result->product_id != snapshot.product_id) {
+      co_return EitherCmd<StatusableResponse>::error({
+        SYS_VERSION,
+        "Snapshot was taken from Z-Stack product " + std::to_string(snapshot.product_id) + " but the adapter runs "
+          + std::to_string(version_result->product_id)
+      });
+    }
+
+    for (const auto &[id, data] : snapshot.items) {
+      const auto item = static_cast<DeviceConfiguration>(id);
+      const auto length_result = co_await getItemLength(item);
+      if (!length_result) {
+        co_return EitherCmd<StatusableResponse>::error({
+          SYS_OSAL_NV_LENGTH,
+          "Failed to get length of configuration " + std::to_string(id),
+          length_result
+        });
+      }
+
+      // NV items can't change size in place; recreate any the snapshot disagrees with
+      if (length_result->length > 0 && length_result->length != data.size()) {
+        const auto delete_result = co_await deleteItem(item);
+        if (!delete_result || delete_result->status != SYS_OSAL_NV_DELETE_SUCCESS) {
+          co_return EitherCmd<StatusableResponse>::error({
+            SYS_OSAL_NV_DELETE,
+            "Failed to resize NV Item [" + std::to_string(id) + "]"
+          });
+        }
+      }
+
+      const auto write_result = co_await writeItem(item, data, true, true);
+      if (!write_result || !write_result->status) {
+        co_return write_result;
+      }
+    }
+
+    co_return StatusableResponse::success();
+  }
+
+  ZnpNvTransferStatistics ZigbeeNetworkProcessor::nvTransferStatistics() const {
+    std::lock_guard lock(nv_statistics_mutex);
+    return nv_statistics;
+  }
+
+  std::optional<ZnpNvCacheStatistics> ZigbeeNetworkProcessor::nvCacheStatistics() const {
+    if (!nv_cache) {
+      return std::nullopt;
+    }
+    return nv_cache->statistics();
+  }
+
+  void ZigbeeNetworkProcessor::primeItemLengths(const std::map<uint16_t, uint16_t> &item_lengths) {
+    if (!nv_cache) {
+      return;
+    }
+    for (const auto &[item, length] : item_lengths) {
+      nv_cache->storeLength(item, length);
+    }
+  }
+
   [[nodiscard]] TaskEitherCmd<SysOsalNvDeleteResponse> ZigbeeNetworkProcessor::deleteItem(const DeviceConfiguration device_configuration) {
     Logger::debug(TAG(), "Deleting NV Item [" + std::to_string(device_configuration) + "]");
     const auto length_result = co_await getItemLength(device_configuration);
     if (!length_result) {
-      co_return EitherCmd<SysOsalNvReadResponse<std::vector<uint8_t>>>::error({
+      co_return EitherCmd<SysOsalNvDeleteResponse>::error({
         SYS_OSAL_NV_LENGTH,
         "Failed to get length of configuration " + std::to_string(device_configuration),
         length_result
@@ -389,42 +897,62 @@ namespace lcl::zigbee::adapter::zstack {
     Logger::trace(TAG(), "[Send]: SYS_OSAL_NV_DELETE >>>");
     const auto result = co_await sendRequest(sysOsalNvDelete(device_configuration, length_result->length));
     Logger::trace(TAG(), "[Recv]: SYS_OSAL_NV_DELETE <<<");
+    if (nv_cache) {
+      nv_cache->invalidate(device_configuration);
+    }
     co_return SysOsalNvDeleteResponse::parse(result);
   }
 
   TaskEitherCmd<SysOsalNvLengthResponse> ZigbeeNetworkProcessor::getItemLength(const DeviceConfiguration device_configuration) {
+    if (nv_cache) {
+      if (const auto length = nv_cache->length(device_configuration)) {
+        co_return EitherCmd<SysOsalNvLengthResponse>::value({ *length });
+      }
+    }
+
     Logger::trace(TAG(), "[Send]: SYS_GET_LENGTH_REQ >>>");
     const auto result = co_await sendRequest(sysOsalNvLength(device_configuration));
     Logger::trace(TAG(), "[Recv]: SYS_GET_LENGTH_REQ <<<");
-    co_return SysOsalNvLengthResponse::parse(result);
+    auto parsed_result = SysOsalNvLengthResponse::parse(result);
+    if (nv_cache && parsed_result) {
+      nv_cache->storeLength(device_configuration, parsed_result->length);
+    }
+    co_return parsed_result;
   }
 
   TaskEitherCmd<SysPingResponse> ZigbeeNetworkProcessor::ping() {
-    Logger::info(TAG(), "Pinging adapter");
-    Logger::trace(TAG(), "[Send]: SYS_PING >>>");
-    const auto result = co_await sendRequest(sysPing());
-    Logger::trace(TAG(), "[Recv]: SYS_PING <<<");
-    co_return SysPingResponse::parse(result);
+    co_return co_await ping_query.run([this]() -> TaskEitherCmd<SysPingResponse> {
+      Logger::info(TAG(), "Pinging adapter");
+      Logger::trace(TAG(), "[Send]: SYS_PING >>>");
+      const auto result = co_await sendRequest(sysPing());
+      Logger::trace(TAG(), "[Recv]: SYS_PING <<<");
+      co_return SysPingResponse::parse(result);
+    }, connection_options.query_ttl);
   }
 
   TaskEitherCmd<SysResetCallback> ZigbeeNetworkProcessor::reset(const bool soft_reset) {
     Logger::trace(TAG(), "[Send]: SYS_RESET_REQ (async) >>>");
     const auto result = co_await sendRequest(sysResetReq(soft_reset));
     Logger::trace(TAG(), "[Recv]: SYS_RESET_IND (async) <<<");
+    // Startup options may have cleared the configuration or network state
+    if (nv_cache) {
+      nv_cache->clear();
+    }
+    device_info_query.invalidate();
     co_return SysResetCallback::parse(result);
   }
 
   TaskEitherCmd<SysVersionResponse> ZigbeeNetworkProcessor::getVersion(const bool force_reload) {
-    if (!force_reload && version.has_value()) {
-      co_return EitherCmd<SysVersionResponse>::value(version.value());
+    if (force_reload) {
+      version_query.invalidate();
     }
 
-    Logger::trace(TAG(), "[Send]: SYS_VERSION >>>");
-    const auto result = co_await sendRequest(sysVersion());
-    Logger::trace(TAG(), "[Recv]: SYS_VERSION <<<");
-    const auto parsed_result = SysVersionResponse::parse(result);
-    version = *parsed_result;
-    co_return parsed_result;
+    co_return co_await version_query.run([this]() -> TaskEitherCmd<SysVersionResponse> {
+      Logger::trace(TAG(), "[Send]: SYS_VERSION >>>");
+      const auto result = co_await sendRequest(sysVersion());
+      Logger::trace(TAG(), "[Recv]: SYS_VERSION <<<");
+      co_return SysVersionResponse::parse(result);
+    }, async::single_flight<EitherCmd<SysVersionResponse>>::clock::duration::max());
   }
 
   TaskEitherCmd<StatusableResponse> ZigbeeNetworkProcessor::setStartupOptions(const ZnpStartupOptions& options) {
@@ -440,11 +968,7 @@ namespace lcl::zigbee::adapter::zstack {
       configuration |= ZCD_STARTOPT_CLEAR_CONFIG;
     }
 
-    const auto result = writeItem(
-      ZCD_NV_STARTUP_OPTION,
-      std::vector({configuration}));
-
-    return result;
+    co_return co_await writeItem(ZCD_NV_STARTUP_OPTION, std::vector<uint8_t>(1, configuration));
   }
 
   TaskEitherCmd<SysOsalNvReadResponse<ZnpStartupOptions>> ZigbeeNetworkProcessor::getStartupOptions() {
@@ -469,48 +993,27 @@ namespace lcl::zigbee::adapter::zstack {
 
   TaskEitherCmd<StatusableResponse> ZigbeeNetworkProcessor::setLogicalType(const LogicalType type) {
     Logger::info(TAG(), "Setting adapter logical type");
-    const auto result = writeItem(
-      ZCD_NV_LOGICAL_TYPE,
-      std::vector<uint8_t>({type}));
-    return result;
+    co_return co_await writeItem(ZCD_NV_LOGICAL_TYPE, std::vector<uint8_t>(1, type));
   }
 
   TaskEitherCmd<StatusableResponse> ZigbeeNetworkProcessor::setPanID(const uint16_t pan_id) {
     Logger::info(TAG(), "Setting adapter PAN ID");
-    const auto result = writeItem(
-      ZCD_NV_PAN_ID,
-      std::vector({
-        TO_VECTOR_ARG_LITTLE_ENDIAN_U16(pan_id)
-      }));
-    return result;
+    co_return co_await writeItem(ZCD_NV_PAN_ID, panIdItem(pan_id));
   }
 
   TaskEitherCmd<StatusableResponse> ZigbeeNetworkProcessor::setExtendedPanID(const uint64_t extended_pan_id) {
     Logger::info(TAG(), "Setting adapter extended PAN ID");
-    const auto result = writeItem(
-      ZCD_NV_EXTENDED_PAN_ID,
-      std::vector({
-        TO_VECTOR_ARG_LITTLE_ENDIAN_U64(extended_pan_id)
-      }));
-    return result;
+    co_return co_await writeItem(ZCD_NV_EXTENDED_PAN_ID, extendedPanIdItem(extended_pan_id));
   }
 
   TaskEitherCmd<StatusableResponse> ZigbeeNetworkProcessor::setApsUseExtendedPanID(const uint64_t extended_pan_id) {
     Logger::info(TAG(), "Setting adapter APS use extended PAN ID");
-    const auto result = writeItem(
-      ZCD_NV_APS_USE_EXT_PANID,
-      std::vector({
-        TO_VECTOR_ARG_LITTLE_ENDIAN_U64(extended_pan_id)
-      }));
-    return result;
+    co_return co_await writeItem(ZCD_NV_APS_USE_EXT_PANID, extendedPanIdItem(extended_pan_id));
   }
 
   TaskEitherCmd<StatusableResponse> ZigbeeNetworkProcessor::setPreconfiguredKeysEnabled(const bool enabled) {
     Logger::info(TAG(), "Enabling adapter preconfigured keys");
-    const auto result = writeItem(
-      ZCD_NV_PRECFGKEYS_ENABLE,
-      std::vector({static_cast<uint8_t>(enabled ? 0x01 : 0x00)}));
-    return result;
+    co_return co_await writeItem(ZCD_NV_PRECFGKEYS_ENABLE, flagItem(enabled));
   }
 
   TaskEitherCmd<StatusableResponse> ZigbeeNetworkProcessor::setPreconfiguredKeys(const std::array<uint8_t, 16>& key) {
@@ -518,9 +1021,10 @@ namespace lcl::zigbee::adapter::zstack {
     const auto version = co_await getVersion();
 
     if (std::set<uint8_t>({ZNP_VERSION_ZSTACK_3x0, ZNP_VERSION_ZSTACK_30x}).contains(version->product_id)) {
-      const auto result = writeItem(
+      const auto result = co_await writeItem(
         ZCD_NV_PRECFGKEYS,
         std::vector(key.begin(), key.end()));
+      CORETURN_ON_FALSY(result);
     } else {
       const auto write_prec_keys_result = co_await writeConfiguration(CONF_PROP_PRECFGKEYS, std::vector(key.begin(), key.end()));
       CORETURN_ON_FALSY(write_prec_keys_result);
@@ -541,8 +1045,10 @@ namespace lcl::zigbee::adapter::zstack {
   }
 
   TaskEitherCmd<GetDeviceInfoResponse> ZigbeeNetworkProcessor::getDeviceInfo() {
-    Logger::info(TAG(), "Getting device info");
-    co_return GetDeviceInfoResponse::parse(co_await sendRequest(utilGetDeviceInfo()));
+    co_return co_await device_info_query.run([this]() -> TaskEitherCmd<GetDeviceInfoResponse> {
+      Logger::info(TAG(), "Getting device info");
+      co_return GetDeviceInfoResponse::parse(co_await sendRequest(utilGetDeviceInfo()));
+    }, connection_options.query_ttl);
   }
 
   TaskEitherCmd<StatusableResponse> ZigbeeNetworkProcessor::getActiveEndpoints(const uint16_t destination_address,
@@ -566,11 +1072,39 @@ namespace lcl::zigbee::adapter::zstack {
     });
   }
 
+  TaskEitherCmd<bool> ZigbeeNetworkProcessor::networkItemsMatch(const ZnpNetworkOptions &network_options) {
+    uint32_t channel_bitmask = 0;
+    for (const auto channel : network_options.channel_list) {
+      channel_bitmask |= 1u << channel;
+    }
+
+    const std::pair<DeviceConfiguration, std::vector<uint8_t>> expected_items[] = {
+      { ZCD_NV_LOGICAL_TYPE, { LOGICAL_TYPE_COORDINATOR } },
+      { ZCD_NV_ZDO_DIRECT_CB, flagItem(true) },
+      { ZCD_NV_CHANLIST, channelListItem(channel_bitmask) },
+      { ZCD_NV_PAN_ID, panIdItem(network_options.pan_id) },
+      { ZCD_NV_EXTENDED_PAN_ID, extendedPanIdItem(network_options.extended_pan_id) },
+      { ZCD_NV_APS_USE_EXT_PANID, extendedPanIdItem(network_options.extended_pan_id) },
+      { ZCD_NV_PRECFGKEYS_ENABLE, flagItem(network_options.network_key_distribute) },
+      { ZCD_NV_PRECFGKEYS, std::vector(network_options.network_key.begin(), network_options.network_key.end()) }
+    };
+
+    // Stop at the first difference; the caller recommissions from scratch either way
+    for (const auto &[configuration, expected] : expected_items) {
+      const auto current = co_await readItem(configuration);
+      CORETURN_ON_FALSY(current);
+      if (current->data != expected) {
+        Logger::debug(TAG(), "NV Item [" + std::to_string(configuration) + "] differs from the network options");
+        co_return EitherCmd<bool>::value(false);
+      }
+    }
+
+    co_return EitherCmd<bool>::value(true);
+  }
+
   TaskEitherCmd<StatusableResponse> ZigbeeNetworkProcessor::setZdoDirectCallback(const bool enabled) {
     Logger::info(TAG(), "Setting ZDO direct callback");
-    const auto result = co_await writeItem(
-      ZCD_NV_ZDO_DIRECT_CB,
-      std::vector({static_cast<uint8_t>(enabled ? 0x01 : 0x00)}));
+    const auto result = co_await writeItem(ZCD_NV_ZDO_DIRECT_CB, flagItem(enabled));
     co_return result;
   }
 
@@ -581,12 +1115,7 @@ namespace lcl::zigbee::adapter::zstack {
       bitmask |= channel;
     }
 
-    auto channel_buffer = std::vector<uint8_t>(4);
-    SET_VECTOR_AT_LITTLE_ENDIAN_U32(channel_buffer, 0, bitmask);
-    const auto result = writeItem(
-      ZCD_NV_CHANLIST,
-      channel_buffer);
-    return result;
+    co_return co_await writeItem(ZCD_NV_CHANLIST, channelListItem(bitmask));
   }
 
   TaskEitherCmd<StatusableResponse> ZigbeeNetworkProcessor::deleteNetworkInformationBlock() {
@@ -614,9 +1143,71 @@ namespace lcl::zigbee::adapter::zstack {
     Logger::trace(TAG(), "[Send]: APP_CNF_BDB_START_COMMISSIONING >>>");
     const auto result = co_await sendRequest(appCnfBdbStartCommissioning(mode));
     Logger::trace(TAG(), "[Recv]: APP_CNF_BDB_START_COMMISSIONING <<<");
+    // Forming or joining a network rewrites NV items behind our back
+    if (nv_cache) {
+      nv_cache->clear();
+    }
+    device_info_query.invalidate();
     co_return StatusableResponse::parse(result);
   }
 
+  async::Task<bool> ZigbeeNetworkProcessor::waitForCoordinatorStarted(
+    const std::chrono::milliseconds timeout,
+    const std::stop_token stop
+  ) {
+    DeferredTask<bool> started { response_executor };
+    started.get_resolver().cancel_on(stop);
+
+    const auto state_handler = dispatcher.addHandler(
+      { SUBSYSTEM_ZDO, ZDO_STATE_CHANGE_IND },
+      [resolver = started.get_resolver()](const RawZnpResponse &frame) {
+        if (frame.payload.empty()) return;
+        Logger::debug(TAG(), "Device state changed to %02X", frame.payload[0]);
+        if (frame.payload[0] == DEVICE_STATE_STARTED_AS_COORDINATOR) {
+          resolver.resolve(true);
+        }
+      });
+    const auto commissioning_handler = dispatcher.addHandler(
+      { SUBSYSTEM_APP_CNF, MT_APP_CNF_BDB_COMMISSIONING_NOTIFICATION },
+      [resolver = started.get_resolver()](const RawZnpResponse &frame) {
+        if (frame.payload.empty()) return;
+        Logger::debug(TAG(), "BDB commissioning status %02X", frame.payload[0]);
+        switch (frame.payload[0]) {
+          case BDB_COMMISSIONING_SUCCESS:
+          case BDB_COMMISSIONING_NETWORK_RESTORED:
+            resolver.resolve(true);
+            break;
+          case BDB_COMMISSIONING_NO_NETWORK:
+          case BDB_COMMISSIONING_TCLK_EX_FAILURE:
+          case BDB_COMMISSIONING_FORMATION_FAILURE:
+          case BDB_COMMISSIONING_FAILURE:
+            resolver.resolve(false);
+            break;
+          default:
+            // Still in progress, or a step that doesn't affect the network coming up
+            break;
+        }
+      });
+
+    auto &timers = async::get_timer_service();
+    const auto deadline = timers.schedule_after(timeout, [resolver = started.get_resolver()] {
+      resolver.reject(async::timeout_error("Timed out waiting for the coordinator to start"));
+    });
+
+    try {
+      const auto result = co_await started;
+      timers.cancel(deadline);
+      dispatcher.removeHandler(state_handler);
+      dispatcher.removeHandler(commissioning_handler);
+      co_return result;
+    } catch (...) {
+      timers.cancel(deadline);
+      dispatcher.removeHandler(state_handler);
+      dispatcher.removeHandler(commissioning_handler);
+      throw;
+    }
+  }
+
   TaskEitherCmd<StatusableResponse> ZigbeeNetworkProcessor::writeConfiguration(
     const ConfigurationProperty property,
     const std::vector<uint8_t> &data
@@ -624,6 +1215,9 @@ namespace lcl::zigbee::adapter::zstack {
     Logger::trace(TAG(), "[Send]: SAPI_WRITE_CONFIGURATION >>>");
     const auto result = co_await sendRequest(sapiWriteConfiguration(property, data));
     Logger::trace(TAG(), "[Recv]: SAPI_WRITE_CONFIGURATION <<<");
+    if (nv_cache) {
+      nv_cache->invalidate(property);
+    }
     co_return StatusableResponse::parse(result);
   }
 
@@ -635,6 +1229,9 @@ namespace lcl::zigbee::adapter::zstack {
     Logger::trace(TAG(), "[Send]: SAPI_WRITE_CONFIGURATION >>>");
     const auto result = co_await sendRequest(sapiWriteConfiguration(property, begin, end));
     Logger::trace(TAG(), "[Recv]: SAPI_WRITE_CONFIGURATION <<<");
+    if (nv_cache) {
+      nv_cache->invalidate(property);
+    }
     co_return StatusableResponse::parse(result);
   }
 }
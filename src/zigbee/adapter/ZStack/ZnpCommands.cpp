@@ -1,25 +1,48 @@
 #include <zigbee/adapter/ZStack/ZnpCommands.hpp>
 
+#include <algorithm>
+#include <stdexcept>
+
 #include "util/VectorUtil.hpp"
-#include "zigbee/adapter/ZStack/ZNPTypes.hpp"
+#include "zigbee/adapter/ZStack/ZnpCommandDescriptors.hpp"
+#include "zigbee/adapter/ZStack/ZnpTypes.hpp"
 
 namespace lcl::zigbee::adapter::zstack {
+  std::vector<ZnpNvChunk> nvChunks(const std::size_t offset, const std::size_t length, const std::size_t chunk_length) {
+    if (chunk_length == 0) {
+      throw std::invalid_argument("NV chunks must hold at least one byte");
+    }
+
+    std::vector<ZnpNvChunk> chunks;
+    if (offset < length) {
+      chunks.reserve((length - offset + chunk_length - 1) / chunk_length);
+    }
+    for (auto begin = offset; begin < length; begin += chunk_length) {
+      chunks.push_back({ begin, std::min(length, begin + chunk_length) });
+    }
+    return chunks;
+  }
+
+  bool nvChunksFitShortOffsets(const std::vector<ZnpNvChunk> &chunks) {
+    return std::ranges::all_of(chunks, [](const ZnpNvChunk &chunk) { return chunk.begin <= ZNP_NV_MAX_SHORT_OFFSET; });
+  }
+
   ZnpCommand sysResetReq(const bool soft_reset) {
-    auto buffer = std::vector<uint8_t>(1);
+    auto buffer = ZnpPayload(1);
     buffer.at(0) = soft_reset ? 1 : 0;
-    return ZnpCommand { SYS_RESET_REQ, SUBSYSTEM_SYS, AREQ, buffer, SYS_RESET_IND };
+    return makeCommand<SUBSYSTEM_SYS, SYS_RESET_REQ>(buffer);
   }
 
   ZnpCommand sysPing() {
-    return ZnpCommand { SYS_PING, SUBSYSTEM_SYS, SREQ, {} };
+    return makeCommand<SUBSYSTEM_SYS, SYS_PING>();
   }
 
   ZnpCommand sysVersion() {
-    return ZnpCommand { SYS_VERSION, SUBSYSTEM_SYS, SREQ, {} };
+    return makeCommand<SUBSYSTEM_SYS, SYS_VERSION>();
   }
 
   ZnpCommand appCnfBdbSetChannel(const bool is_primary, const std::set<ZnpChannelMask> &channels) {
-    auto buffer = std::vector<uint8_t>(5);
+    auto buffer = ZnpPayload(5);
     buffer.at(0) = is_primary ? 0x01 : 0x00;
 
     uint32_t bitmask = 0;
@@ -28,24 +51,24 @@ namespace lcl::zigbee::adapter::zstack {
     }
     SET_VECTOR_AT_LITTLE_ENDIAN_U32(buffer, 1, bitmask);
 
-    return ZnpCommand { MT_APP_CNF_BDB_SET_CHANNEL, SUBSYSTEM_APP_CNF, SREQ, buffer };
+    return makeCommand<SUBSYSTEM_APP_CNF, MT_APP_CNF_BDB_SET_CHANNEL>(buffer);
   }
 
   ZnpCommand appCnfBdbStartCommissioning(ZnpCommissioningMode mode) {
-    auto buffer = std::vector(std::vector{ static_cast<uint8_t>(mode) });
-    return ZnpCommand { MT_APP_CNF_BDB_START_COMMISSIONING, SUBSYSTEM_APP_CNF, SREQ, buffer };
+    const auto buffer = ZnpPayload({ static_cast<uint8_t>(mode) });
+    return makeCommand<SUBSYSTEM_APP_CNF, MT_APP_CNF_BDB_START_COMMISSIONING>(buffer);
   }
 
   ZnpCommand sapiWriteConfiguration(
     const uint8_t configuration_id,
     const std::vector<uint8_t> &data
   ) {
-    auto buffer = std::vector<uint8_t>(2 + data.size());
+    auto buffer = ZnpPayload(2 + data.size());
     buffer.at(0) = configuration_id;
     buffer.at(1) = data.size();
     FILL_VECTOR(buffer, 2, data);
 
-    return ZnpCommand { SAPI_WRITE_CONFIGURATION, SUBSYSTEM_SAPI, SREQ, buffer };
+    return makeCommand<SUBSYSTEM_SAPI, SAPI_WRITE_CONFIGURATION>(buffer);
   }
 
   ZnpCommand sapiWriteConfiguration(
@@ -53,25 +76,22 @@ namespace lcl::zigbee::adapter::zstack {
     const std::vector<uint8_t>::const_iterator &begin,
     const std::vector<uint8_t>::const_iterator &end
   ) {
-    auto buffer = std::vector<uint8_t>(2 + (end - begin));
+    auto buffer = ZnpPayload(2);
     buffer.at(0) = configuration_id;
     buffer.at(1) = end - begin;
-    auto index = 2;
-    for (auto it = begin; it != end; ++it) {
-      buffer.at(index++) = *it;
-    }
+    buffer.append(begin, end);
 
-    return ZnpCommand { SAPI_WRITE_CONFIGURATION, SUBSYSTEM_SAPI, SREQ, buffer };
+    return makeCommand<SUBSYSTEM_SAPI, SAPI_WRITE_CONFIGURATION>(buffer);
   }
 
   ZnpCommand sysOsalNvWrite(const DeviceConfiguration id, const uint8_t offset, const std::vector<uint8_t> &data) {
-    auto buffer = std::vector<uint8_t>(4 + data.size());
+    auto buffer = ZnpPayload(4 + data.size());
     SET_VECTOR_AT_LITTLE_ENDIAN_U16(buffer, 0, id);
     buffer.at(2) = offset;
     buffer.at(3) = data.size();
     FILL_VECTOR(buffer, 4, data);
 
-    return ZnpCommand { SYS_OSAL_NV_WRITE, SUBSYSTEM_SYS, SREQ, buffer };
+    return makeCommand<SUBSYSTEM_SYS, SYS_OSAL_NV_WRITE>(buffer);
   }
 
   ZnpCommand sysOsalNvWrite(
@@ -80,26 +100,23 @@ namespace lcl::zigbee::adapter::zstack {
     const std::vector<uint8_t>::const_iterator &begin,
     const std::vector<uint8_t>::const_iterator &end
   ) {
-    auto buffer = std::vector<uint8_t>(4 + (end - begin));
+    auto buffer = ZnpPayload(4);
     SET_VECTOR_AT_LITTLE_ENDIAN_U16(buffer, 0, id);
     buffer.at(2) = offset;
     buffer.at(3) = end - begin;
-    auto index = 4;
-    for (auto it = begin; it != end; ++it) {
-      buffer.at(index++) = *it;
-    }
+    buffer.append(begin, end);
 
-    return ZnpCommand { SYS_OSAL_NV_WRITE, SUBSYSTEM_SYS, SREQ, buffer };
+    return makeCommand<SUBSYSTEM_SYS, SYS_OSAL_NV_WRITE>(buffer);
   }
 
   ZnpCommand sysOsalNvWriteExt(const DeviceConfiguration id, const uint16_t offset, const std::vector<uint8_t> &data) {
-    auto buffer = std::vector<uint8_t>(6 + data.size());
+    auto buffer = ZnpPayload(6 + data.size());
     SET_VECTOR_AT_LITTLE_ENDIAN_U16(buffer, 0, id);
     SET_VECTOR_AT_LITTLE_ENDIAN_U16(buffer, 2, offset);
     SET_VECTOR_AT_LITTLE_ENDIAN_U16(buffer, 4, data.size());
     FILL_VECTOR(buffer, 6, data);
 
-    return ZnpCommand { SYS_OSAL_NV_WRITE_EXT, SUBSYSTEM_SYS, SREQ, buffer };
+    return makeCommand<SUBSYSTEM_SYS, SYS_OSAL_NV_WRITE_EXT>(buffer);
   }
 
   ZnpCommand sysOsalNvWriteExt(
@@ -108,47 +125,44 @@ namespace lcl::zigbee::adapter::zstack {
     const std::vector<uint8_t>::const_iterator &begin,
     const std::vector<uint8_t>::const_iterator &end
   ) {
-    auto buffer = std::vector<uint8_t>(6 + (end - begin));
+    auto buffer = ZnpPayload(6);
     SET_VECTOR_AT_LITTLE_ENDIAN_U16(buffer, 0, id);
     SET_VECTOR_AT_LITTLE_ENDIAN_U16(buffer, 2, offset);
     SET_VECTOR_AT_LITTLE_ENDIAN_U16(buffer, 4, end - begin);
-    auto index = 6;
-    for (auto it = begin; it != end; ++it) {
-      buffer.at(index++) = *it;
-    }
+    buffer.append(begin, end);
 
-    return ZnpCommand { SYS_OSAL_NV_WRITE_EXT, SUBSYSTEM_SYS, SREQ, buffer };
+    return makeCommand<SUBSYSTEM_SYS, SYS_OSAL_NV_WRITE_EXT>(buffer);
   }
 
   ZnpCommand sysOsalNvLength(const DeviceConfiguration id) {
-    auto buffer = std::vector(std::vector({
+    auto buffer = ZnpPayload({
       TO_VECTOR_ARG_LITTLE_ENDIAN_U16(id)
-    }));
-    return ZnpCommand { SYS_OSAL_NV_LENGTH, SUBSYSTEM_SYS, SREQ, buffer };
+    });
+    return makeCommand<SUBSYSTEM_SYS, SYS_OSAL_NV_LENGTH>(buffer);
   }
 
   ZnpCommand sysOsalNvRead(const DeviceConfiguration id, const uint8_t offset) {
-    auto buffer = std::vector(std::vector({
+    auto buffer = ZnpPayload({
       TO_VECTOR_ARG_LITTLE_ENDIAN_U16(id),
       offset,
-    }));
-    return ZnpCommand { SYS_OSAL_NV_READ, SUBSYSTEM_SYS, SREQ, buffer };
+    });
+    return makeCommand<SUBSYSTEM_SYS, SYS_OSAL_NV_READ>(buffer);
   }
 
   ZnpCommand sysOsalNvReadExt(const DeviceConfiguration id, const uint16_t offset) {
-    auto buffer = std::vector(std::vector({
+    auto buffer = ZnpPayload({
       TO_VECTOR_ARG_LITTLE_ENDIAN_U16(id),
       TO_VECTOR_ARG_LITTLE_ENDIAN_U16(offset),
-    }));
-    return ZnpCommand { SYS_OSAL_NV_READ_EXT, SUBSYSTEM_SYS, SREQ, buffer };
+    });
+    return makeCommand<SUBSYSTEM_SYS, SYS_OSAL_NV_READ_EXT>(buffer);
   }
 
   ZnpCommand sysOsalNvDelete(const DeviceConfiguration id, const uint16_t length) {
-    auto buffer = std::vector(std::vector({
+    auto buffer = ZnpPayload({
       TO_VECTOR_ARG_LITTLE_ENDIAN_U16(id),
       TO_VECTOR_ARG_LITTLE_ENDIAN_U16(length),
-    }));
-    return ZnpCommand { SYS_OSAL_NV_DELETE, SUBSYSTEM_SYS, SREQ, buffer };
+    });
+    return makeCommand<SUBSYSTEM_SYS, SYS_OSAL_NV_DELETE>(buffer);
   }
 
   ZnpCommand sysOsalNvItemInit(
@@ -157,38 +171,35 @@ namespace lcl::zigbee::adapter::zstack {
     const std::vector<uint8_t>::const_iterator &begin,
     const std::vector<uint8_t>::const_iterator &end
   ) {
-    auto buffer = std::vector<uint8_t>(5 + (end - begin));
+    auto buffer = ZnpPayload(5);
     SET_VECTOR_AT_LITTLE_ENDIAN_U16(buffer, 0, id);
     SET_VECTOR_AT_LITTLE_ENDIAN_U16(buffer, 2, total_length);
     buffer.at(4) = end - begin;
-    auto index = 5;
-    for (auto it = begin; it != end; ++it) {
-      buffer.at(index++) = *it;
-    }
+    buffer.append(begin, end);
 
-    return ZnpCommand { SYS_OSAL_NV_ITEM_INIT, SUBSYSTEM_SYS, SREQ, buffer };
+    return makeCommand<SUBSYSTEM_SYS, SYS_OSAL_NV_ITEM_INIT>(buffer);
   }
 
   ZnpCommand utilSetPanId(const uint16_t pan_id) {
-    auto buffer = std::vector(std::vector({
+    auto buffer = ZnpPayload({
       TO_VECTOR_ARG_LITTLE_ENDIAN_U16(pan_id)
-    }));
-    return ZnpCommand { UTIL_SET_PAN_ID, SUBSYSTEM_UTIL, SREQ, buffer };
+    });
+    return makeCommand<SUBSYSTEM_UTIL, UTIL_SET_PAN_ID>(buffer);
   }
 
   ZnpCommand utilSetChannels(const uint32_t channels) {
-    auto buffer = std::vector(std::vector({
+    auto buffer = ZnpPayload({
       TO_VECTOR_ARG_LITTLE_ENDIAN_U32(channels)
-    }));
-    return ZnpCommand { UTIL_SET_PAN_ID, SUBSYSTEM_UTIL, SREQ, buffer };
+    });
+    return makeCommand<SUBSYSTEM_UTIL, UTIL_SET_CHANNELS>(buffer);
   }
 
   ZnpCommand utilGetDeviceInfo() {
-    return ZnpCommand { UTIL_GET_DEVICE_INFO, SUBSYSTEM_UTIL, SREQ };
+    return makeCommand<SUBSYSTEM_UTIL, UTIL_GET_DEVICE_INFO>();
   }
 
   ZnpCommand afRegister(const AfEndpointDescription& description) {
-    auto buffer = std::vector<uint8_t>(73);
+    auto buffer = ZnpPayload(73);
     buffer.at(0) = description.endpoint;
     SET_VECTOR_AT_LITTLE_ENDIAN_U16(buffer, 1, description.app_profile_id);
     SET_VECTOR_AT_LITTLE_ENDIAN_U16(buffer, 3, description.app_device_id);
@@ -199,7 +210,7 @@ namespace lcl::zigbee::adapter::zstack {
     buffer.at(9 + 32) = description.app_number_out_clusters;
     FILL_VECTOR(buffer, 10 + 32, description.app_out_cluster_list);
 
-    return ZnpCommand { AF_REGISTER, SUBSYSTEM_AF, SREQ, buffer };
+    return makeCommand<SUBSYSTEM_AF, AF_REGISTER>(buffer);
   }
 
   ZnpCommand zdoActiveEndpointRequest(
@@ -207,13 +218,13 @@ namespace lcl::zigbee::adapter::zstack {
     const uint16_t destination_address,
     const uint16_t network_address_of_interest
   ) {
-    const auto buffer = std::vector(std::vector({
+    const auto buffer = ZnpPayload({
       // TODO: Maybe required?
       static_cast<uint8_t>(zdp_transaction_id),
       TO_VECTOR_ARG_LITTLE_ENDIAN_U16(destination_address),
       TO_VECTOR_ARG_LITTLE_ENDIAN_U16(network_address_of_interest)
-    }));
+    });
 
-    return ZnpCommand { ZDO_ACTIVE_EP_REQ, SUBSYSTEM_ZDO, SREQ, buffer };
+    return makeCommand<SUBSYSTEM_ZDO, ZDO_ACTIVE_EP_REQ>(buffer);
   }
 }
@@ -0,0 +1,158 @@
+/**
+ * Tags: zigbee, zstack, callbacks
+ */
+
+#include "zigbee/adapter/ZStack/ZnpDispatcher.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace lcl::zigbee::adapter::zstack {
+  ZnpSubscription::ZnpSubscription(const std::size_t capacity, async::executor &resume_on)
+    : capacity(std::max<std::size_t>(capacity, 1)), resume_on(resume_on) {}
+
+  async::LazyTask<RawZnpResponse> ZnpSubscription::next() {
+    std::optional<async::DeferredTask<RawZnpResponse>> arrival;
+    {
+      std::lock_guard lock(mutex);
+      if (!queued.empty()) {
+        auto frame = std::move(queued.front());
+        queued.pop_front();
+        co_return frame;
+      }
+
+      arrival.emplace(resume_on);
+      waiting = arrival->get_resolver();
+    }
+
+    co_return co_await *arrival;
+  }
+
+  std::optional<RawZnpResponse> ZnpSubscription::tryNext() {
+    std::lock_guard lock(mutex);
+    if (queued.empty()) {
+      return std::nullopt;
+    }
+
+    auto frame = std::move(queued.front());
+    queued.pop_front();
+    return frame;
+  }
+
+  std::size_t ZnpSubscription::size() const {
+    std::lock_guard lock(mutex);
+    return queued.size();
+  }
+
+  uint64_t ZnpSubscription::dropped() const {
+    std::lock_guard lock(mutex);
+    return frames_dropped;
+  }
+
+  bool ZnpSubscription::push(const RawZnpResponse &frame) {
+    std::optional<async::DeferredTask<RawZnpResponse>::resolver> reader;
+    {
+      std::lock_guard lock(mutex);
+      if (waiting.has_value()) {
+        reader = std::exchange(waiting, std::nullopt);
+      } else {
+        const bool full = queued.size() >= capacity;
+        if (full) {
+          queued.pop_front();
+          frames_dropped++;
+        }
+        queued.push_back(frame);
+        return full;
+      }
+    }
+
+    // The reader may resume inline, so resolve outside the lock
+    reader->resolve(frame);
+    return false;
+  }
+
+  ZnpDispatcher::HandlerId ZnpDispatcher::addHandler(const ZnpCallbackKey key, Handler handler) {
+    std::lock_guard lock(mutex);
+    const auto handler_id = next_handler_id++;
+    routes[key].handlers.emplace_back(handler_id, std::make_shared<const Handler>(std::move(handler)));
+    return handler_id;
+  }
+
+  void ZnpDispatcher::removeHandler(const HandlerId handler_id) {
+    std::lock_guard lock(mutex);
+    for (auto route = routes.begin(); route != routes.end(); ++route) {
+      if (std::erase_if(route->second.handlers, [handler_id](const auto &handler) { return handler.first == handler_id; }) > 0) {
+        if (route->second.handlers.empty() && route->second.subscriptions.empty()) {
+          routes.erase(route);
+        }
+        return;
+      }
+    }
+  }
+
+  std::shared_ptr<ZnpSubscription> ZnpDispatcher::subscribe(
+    const ZnpCallbackKey key,
+    const std::size_t capacity,
+    async::executor &resume_on
+  ) {
+    auto subscription = std::make_shared<ZnpSubscription>(capacity, resume_on);
+    std::lock_guard lock(mutex);
+    routes[key].subscriptions.push_back(subscription);
+    return subscription;
+  }
+
+  bool ZnpDispatcher::dispatch(const RawZnpResponse &frame) {
+    std::vector<std::shared_ptr<const Handler>> handlers;
+    std::vector<std::shared_ptr<ZnpSubscription>> subscriptions;
+    {
+      std::lock_guard lock(mutex);
+      const auto route = routes.find({ frame.subsystem, frame.command });
+      if (route == routes.end()) {
+        stats.frames_unhandled++;
+        return false;
+      }
+
+      for (const auto &[handler_id, handler] : route->second.handlers) {
+        handlers.push_back(handler);
+      }
+      // Released subscriptions are pruned as their frames come through
+      std::erase_if(route->second.subscriptions, [&subscriptions](const auto &weak_subscription) {
+        auto subscription = weak_subscription.lock();
+        if (subscription == nullptr) {
+          return true;
+        }
+        subscriptions.push_back(std::move(subscription));
+        return false;
+      });
+
+      if (handlers.empty() && subscriptions.empty()) {
+        routes.erase(route);
+        stats.frames_unhandled++;
+        return false;
+      }
+      stats.frames_dispatched++;
+    }
+
+    for (const auto &handler : handlers) {
+      (*handler)(frame);
+    }
+
+    uint64_t dropped = 0;
+    for (const auto &subscription : subscriptions) {
+      if (subscription->push(frame)) {
+        dropped++;
+      }
+    }
+    if (dropped > 0) {
+      std::lock_guard lock(mutex);
+      stats.frames_dropped += dropped;
+    }
+
+    return true;
+  }
+
+  ZnpDispatchStatistics ZnpDispatcher::statistics() const {
+    std::lock_guard lock(mutex);
+    return stats;
+  }
+}
@@ -0,0 +1,128 @@
+/**
+ * Tags: zigbee, zstack, persistence
+ */
+
+#include "zigbee/adapter/ZStack/ZnpFingerprint.hpp"
+
+#include <charconv>
+#include <fstream>
+#include <string_view>
+#include <system_error>
+
+namespace lcl::zigbee::adapter::zstack {
+  namespace {
+    std::optional<unsigned long> parseNumber(const std::string_view text, const int base = 10) {
+      unsigned long value = 0;
+      const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value, base);
+      if (error != std::errc() || end != text.data() + text.size()) {
+        return std::nullopt;
+      }
+      return value;
+    }
+  }
+
+  bool ZnpFingerprint::matches(const IEEEAddress &ieee_address, const SysVersionResponse &version) const {
+    return this->ieee_address == ieee_address.toString()
+      && this->version.transport_protocol_revision == version.transport_protocol_revision
+      && this->version.product_id == version.product_id
+      && this->version.major_release == version.major_release
+      && this->version.minor_release == version.minor_release
+      && this->version.maintenance_release == version.maintenance_release;
+  }
+
+  std::optional<ZnpFingerprint> ZnpFingerprint::load(const std::filesystem::path &path) {
+    std::ifstream file(path);
+    if (!file) {
+      return std::nullopt;
+    }
+
+    ZnpFingerprint fingerprint {};
+    bool has_format = false, has_ieee_address = false, has_version = false, has_capabilities = false,
+      has_memory_alignment = false;
+
+    std::string line;
+    while (std::getline(file, line)) {
+      const auto separator = line.find('=');
+      if (separator == std::string::npos) {
+        return std::nullopt;
+      }
+      const auto key = std::string_view(line).substr(0, separator);
+      const auto value = std::string_view(line).substr(separator + 1);
+
+      if (key == "format") {
+        if (parseNumber(value) != FORMAT_VERSION) return std::nullopt;
+        has_format = true;
+      } else if (key == "ieee_address") {
+        fingerprint.ieee_address = value;
+        has_ieee_address = true;
+      } else if (key == "version") {
+        // transport.product.major.minor.maintenance
+        uint8_t parts[5] = {};
+        auto remaining = value;
+        for (auto &part : parts) {
+          const auto dot = remaining.find('.');
+          const auto parsed = parseNumber(remaining.substr(0, dot));
+          if (!parsed || *parsed > 0xFF) return std::nullopt;
+          part = static_cast<uint8_t>(*parsed);
+          remaining = dot == std::string_view::npos ? std::string_view() : remaining.substr(dot + 1);
+        }
+        fingerprint.version = SysVersionResponse { parts[0], parts[1], parts[2], parts[3], parts[4] };
+        has_version = true;
+      } else if (key == "capabilities") {
+        const auto bitmask = parseNumber(value, 16);
+        if (!bitmask || *bitmask > 0xFFFF) return std::nullopt;
+        fingerprint.capabilities = ZnpCapabilities(static_cast<uint16_t>(*bitmask));
+        has_capabilities = true;
+      } else if (key == "memory_alignment") {
+        const auto alignment = parseNumber(value);
+        if (alignment != ZNP_MEMORY_ALIGNMENT_UNALIGNED && alignment != ZNP_MEMORY_ALIGNMENT_ALIGNED) return std::nullopt;
+        fingerprint.memory_alignment = static_cast<ZnpMemoryAlignment>(*alignment);
+        has_memory_alignment = true;
+      } else if (key.starts_with("item_length.")) {
+        const auto item = parseNumber(key.substr(key.find('.') + 1), 16);
+        const auto length = parseNumber(value);
+        if (!item || !length || *item > 0xFFFF || *length > 0xFFFF) return std::nullopt;
+        fingerprint.item_lengths[static_cast<uint16_t>(*item)] = static_cast<uint16_t>(*length);
+      }
+      // Unknown keys are ignored so a newer writer can add fields without bumping the format
+    }
+
+    if (!has_format || !has_ieee_address || !has_version || !has_capabilities || !has_memory_alignment) {
+      return std::nullopt;
+    }
+    return fingerprint;
+  }
+
+  bool ZnpFingerprint::save(const std::filesystem::path &path) const {
+    auto temporary_path = path;
+    temporary_path += ".tmp";
+    {
+      std::ofstream file(temporary_path, std::ios::trunc);
+      if (!file) {
+        return false;
+      }
+
+      file << "format=" << static_cast<unsigned>(FORMAT_VERSION) << '\n'
+        << "ieee_address=" << ieee_address << '\n'
+        << "version="
+          << static_cast<unsigned>(version.transport_protocol_revision) << '.'
+          << static_cast<unsigned>(version.product_id) << '.'
+          << static_cast<unsigned>(version.major_release) << '.'
+          << static_cast<unsigned>(version.minor_release) << '.'
+          << static_cast<unsigned>(version.maintenance_release) << '\n'
+        << "capabilities=" << std::hex << capabilities.bitmask << std::dec << '\n'
+        << "memory_alignment=" << static_cast<unsigned>(memory_alignment) << '\n';
+      for (const auto &[item, length] : item_lengths) {
+        file << "item_length." << std::hex << item << std::dec << '=' << length << '\n';
+      }
+
+      if (!file.flush()) {
+        return false;
+      }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary_path, path, error);
+    return !error;
+  }
+}
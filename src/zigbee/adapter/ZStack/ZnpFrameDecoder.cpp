@@ -0,0 +1,82 @@
+/**
+ * Tags: zigbee, zstack, framing
+ */
+
+#include "zigbee/adapter/ZStack/ZnpFrameDecoder.hpp"
+
+#include <algorithm>
+
+namespace lcl::zigbee::adapter::zstack {
+  RawZnpResponse ZnpFrameView::materialize() const {
+    return RawZnpResponse { command, subsystem, type, std::vector(payload.begin(), payload.end()) };
+  }
+
+  std::size_t ZnpFrameDecoder::write(const std::span<const uint8_t> data) {
+    const auto accepted = std::min(data.size(), CAPACITY - size());
+    for (std::size_t i = 0; i < accepted; i++) {
+      ring[(tail + i) & (CAPACITY - 1)] = data[i];
+    }
+    tail += accepted;
+    return accepted;
+  }
+
+  std::optional<ZnpFrameView> ZnpFrameDecoder::next() {
+    while (size() > 0) {
+      if (at(0) != SOF) {
+        head++;
+        stats.bytes_discarded++;
+        continue;
+      }
+
+      // Not enough bytes
+      if (size() < 2) {
+        return std::nullopt;
+      }
+
+      const std::size_t length = at(1);
+      if (length > ZNP_MAX_PAYLOAD_LENGTH) {
+        // Treat this SOF as noise and rescan from the following byte
+        head++;
+        stats.length_failures++;
+        continue;
+      }
+
+      if (size() < length + ZNP_FRAME_OVERHEAD) {
+        return std::nullopt;
+      }
+
+      uint8_t checksum = 0;
+      for (std::size_t i = 1; i < length + 4; i++) {
+        checksum ^= at(i);
+      }
+      if (checksum != at(length + 4)) {
+        // The length byte may be what got corrupted so only skip this SOF; a valid frame may start inside the span we
+        // would otherwise have thrown away
+        head++;
+        stats.checksum_failures++;
+        continue;
+      }
+
+      const auto type = static_cast<Type>(at(2) >> 5);
+      const auto subsystem = static_cast<Subsystem>(0x1F & at(2));
+      const auto command_id = static_cast<MtCommandId>(at(3));
+
+      const auto payload_start = (head + 4) & (CAPACITY - 1);
+      std::span<const uint8_t> payload;
+      if (payload_start + length <= CAPACITY) {
+        payload = std::span(ring.data() + payload_start, length);
+      } else {
+        const auto first = CAPACITY - payload_start;
+        std::copy_n(ring.begin() + payload_start, first, wrapped_payload.begin());
+        std::copy_n(ring.begin(), length - first, wrapped_payload.begin() + first);
+        payload = std::span(wrapped_payload.data(), length);
+      }
+
+      head += length + ZNP_FRAME_OVERHEAD;
+      stats.frames_decoded++;
+      return ZnpFrameView { command_id, subsystem, type, payload };
+    }
+
+    return std::nullopt;
+  }
+}
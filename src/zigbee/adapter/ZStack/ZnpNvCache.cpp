@@ -0,0 +1,128 @@
+/**
+ * Tags: zigbee, zstack, nv
+ */
+
+#include "zigbee/adapter/ZStack/ZnpNvCache.hpp"
+
+namespace lcl::zigbee::adapter::zstack {
+  ZnpNvCache::ZnpNvCache(async::executor &resume_on) : resume_on(resume_on) {}
+
+  std::optional<uint16_t> ZnpNvCache::length(const uint16_t item) {
+    std::lock_guard lock(mutex);
+    const auto entry = entries.find(item);
+    if (entry == entries.end() || !entry->second.length.has_value()) {
+      stats.misses++;
+      return std::nullopt;
+    }
+    stats.hits++;
+    return entry->second.length;
+  }
+
+  std::optional<std::vector<uint8_t>> ZnpNvCache::contents(const uint16_t item) {
+    std::lock_guard lock(mutex);
+    const auto entry = entries.find(item);
+    if (entry == entries.end() || !entry->second.contents.has_value()) {
+      stats.misses++;
+      return std::nullopt;
+    }
+    stats.hits++;
+    return entry->second.contents;
+  }
+
+  void ZnpNvCache::storeLength(const uint16_t item, const uint16_t length) {
+    std::lock_guard lock(mutex);
+    auto &entry = entries[item];
+    if (entry.length != length) {
+      entry.contents.reset();
+      // A read that started before the item changed size mustn't cache what it read
+      generation++;
+    }
+    entry.length = length;
+  }
+
+  void ZnpNvCache::storeContents(const uint16_t item, const std::vector<uint8_t> &data) {
+    std::lock_guard lock(mutex);
+    auto &entry = entries[item];
+    entry.length = static_cast<uint16_t>(data.size());
+    if (!isVolatile(item)) {
+      entry.contents = data;
+    }
+    // A read that overlapped the write may have seen it half done; it mustn't replace what was just stored
+    generation++;
+  }
+
+  void ZnpNvCache::invalidate(const uint16_t item) {
+    std::lock_guard lock(mutex);
+    entries.erase(item);
+    generation++;
+  }
+
+  void ZnpNvCache::clear() {
+    std::lock_guard lock(mutex);
+    entries.clear();
+    generation++;
+  }
+
+  ZnpNvCache::ReadTicket ZnpNvCache::beginRead(const uint16_t item) {
+    std::lock_guard lock(mutex);
+    ReadTicket ticket { std::nullopt, generation };
+    if (const auto waiting = waiting_reads.find(item); waiting != waiting_reads.end()) {
+      ticket.in_flight.emplace(resume_on);
+      waiting->second.push_back(ticket.in_flight->get_resolver());
+      stats.coalesced++;
+    } else {
+      waiting_reads.emplace(item, std::vector<async::DeferredTask<ReadResult>::resolver> {});
+    }
+    return ticket;
+  }
+
+  void ZnpNvCache::finishRead(const uint16_t item, const uint64_t generation, const ReadResult &result) {
+    if (result && result->status) {
+      std::lock_guard lock(mutex);
+      if (generation == this->generation) {
+        auto &entry = entries[item];
+        entry.length = static_cast<uint16_t>(result->data.size());
+        if (!isVolatile(item)) {
+          entry.contents = result->data;
+        }
+      }
+    }
+
+    // Waiters may resume inline, so resolve outside the lock
+    for (const auto &waiter : takeWaiters(item)) {
+      waiter.resolve(result);
+    }
+  }
+
+  void ZnpNvCache::abandonRead(const uint16_t item, const std::exception_ptr exception) {
+    for (const auto &waiter : takeWaiters(item)) {
+      waiter.reject(exception);
+    }
+  }
+
+  std::vector<async::DeferredTask<ZnpNvCache::ReadResult>::resolver> ZnpNvCache::takeWaiters(const uint16_t item) {
+    std::lock_guard lock(mutex);
+    const auto waiting = waiting_reads.find(item);
+    if (waiting == waiting_reads.end()) {
+      return {};
+    }
+    auto waiters = std::move(waiting->second);
+    waiting_reads.erase(waiting);
+    return waiters;
+  }
+
+  ZnpNvCacheStatistics ZnpNvCache::statistics() const {
+    std::lock_guard lock(mutex);
+    return stats;
+  }
+
+  bool ZnpNvCache::isVolatile(const uint16_t item) {
+    // On Z-Stack 1.2 the network key item also holds the running NWK frame counter
+    return item == ZCD_NV_NIB
+      || item == ZCD_NV_NWKKEY
+      || item == ZCD_NV_NWK_ACTIVE_KEY_INFO
+      || item == ZCD_NV_NWK_ALTERN_KEY_INFO
+      || (item >= ZCD_NV_NWK_SEC_MATERIAL_TABLE_START && item <= ZCD_NV_NWK_SEC_MATERIAL_TABLE_END)
+      || (item >= ZCD_NV_LEGACY_TCLK_TABLE_START_12 && item <= ZCD_NV_APS_LINK_KEY_DATA_END);
+  }
+}
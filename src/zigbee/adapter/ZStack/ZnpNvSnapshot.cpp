@@ -0,0 +1,187 @@
+/**
+ * Tags: zigbee, zstack, persistence
+ */
+
+#include "zigbee/adapter/ZStack/ZnpNvSnapshot.hpp"
+
+#include <array>
+#include <fstream>
+#include <system_error>
+
+namespace lcl::zigbee::adapter::zstack {
+  namespace {
+    constexpr std::array<char, 4> MAGIC = { 'L', 'C', 'L', 'N' };
+
+    constexpr std::array<uint32_t, 256> CRC32_TABLE = [] {
+      std::array<uint32_t, 256> table {};
+      for (uint32_t i = 0; i < table.size(); i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+          crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : crc >> 1;
+        }
+        table[i] = crc;
+      }
+      return table;
+    }();
+
+    uint32_t updateCrc32(uint32_t crc, const void *data, const std::size_t length) {
+      const auto *bytes = static_cast<const uint8_t *>(data);
+      for (std::size_t i = 0; i < length; i++) {
+        crc = CRC32_TABLE[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+      }
+      return crc;
+    }
+
+    /**
+     * Writes to a stream while keeping a running CRC-32 of everything written.
+     */
+    class ChecksummedWriter {
+      std::ostream &stream;
+      uint32_t crc = 0xFFFFFFFF;
+
+    public:
+      explicit ChecksummedWriter(std::ostream &stream) : stream(stream) {}
+
+      void bytes(const void *data, const std::size_t length) {
+        crc = updateCrc32(crc, data, length);
+        stream.write(static_cast<const char *>(data), static_cast<std::streamsize>(length));
+      }
+
+      void u8(const uint8_t value) {
+        bytes(&value, 1);
+      }
+
+      void u16(const uint16_t value) {
+        const uint8_t encoded[] = { static_cast<uint8_t>(value & 0xFF), static_cast<uint8_t>(value >> 8) };
+        bytes(encoded, sizeof(encoded));
+      }
+
+      [[nodiscard]] uint32_t checksum() const {
+        return ~crc;
+      }
+    };
+
+    /**
+     * Reads from a stream while keeping a running CRC-32 of everything read.
+     */
+    class ChecksummedReader {
+      std::istream &stream;
+      uint32_t crc = 0xFFFFFFFF;
+
+    public:
+      explicit ChecksummedReader(std::istream &stream) : stream(stream) {}
+
+      bool bytes(void *data, const std::size_t length) {
+        if (!stream.read(static_cast<char *>(data), static_cast<std::streamsize>(length))) {
+          return false;
+        }
+        crc = updateCrc32(crc, data, length);
+        return true;
+      }
+
+      std::optional<uint8_t> u8() {
+        uint8_t value;
+        return bytes(&value, 1) ? std::optional(value) : std::nullopt;
+      }
+
+      std::optional<uint16_t> u16() {
+        uint8_t encoded[2];
+        return bytes(encoded, sizeof(encoded)) ? std::optional<uint16_t>(encoded[0] | encoded[1] << 8) : std::nullopt;
+      }
+
+      [[nodiscard]] uint32_t checksum() const {
+        return ~crc;
+      }
+    };
+  }
+
+  bool ZnpNvSnapshot::write(std::ostream &stream) const {
+    if (items.size() > 0xFFFF) {
+      return false;
+    }
+
+    ChecksummedWriter writer(stream);
+    writer.bytes(MAGIC.data(), MAGIC.size());
+    writer.u8(FORMAT_VERSION);
+    writer.u8(product_id);
+    writer.u16(static_cast<uint16_t>(items.size()));
+    for (const auto &[item, data] : items) {
+      if (data.size() > 0xFFFF) {
+        return false;
+      }
+      writer.u16(item);
+      writer.u16(static_cast<uint16_t>(data.size()));
+      writer.bytes(data.data(), data.size());
+    }
+
+    const auto checksum = writer.checksum();
+    const uint8_t trailer[] = {
+      static_cast<uint8_t>(checksum), static_cast<uint8_t>(checksum >> 8),
+      static_cast<uint8_t>(checksum >> 16), static_cast<uint8_t>(checksum >> 24)
+    };
+    stream.write(reinterpret_cast<const char *>(trailer), sizeof(trailer));
+    return static_cast<bool>(stream);
+  }
+
+  std::optional<ZnpNvSnapshot> ZnpNvSnapshot::read(std::istream &stream) {
+    ChecksummedReader reader(stream);
+    std::array<char, 4> magic {};
+    if (!reader.bytes(magic.data(), magic.size()) || magic != MAGIC || reader.u8() != FORMAT_VERSION) {
+      return std::nullopt;
+    }
+
+    ZnpNvSnapshot snapshot;
+    const auto product_id = reader.u8();
+    const auto count = reader.u16();
+    if (!product_id || !count) {
+      return std::nullopt;
+    }
+    snapshot.product_id = *product_id;
+
+    for (uint16_t i = 0; i < *count; i++) {
+      const auto item = reader.u16();
+      const auto length = reader.u16();
+      if (!item || !length) {
+        return std::nullopt;
+      }
+      auto &data = snapshot.items[*item];
+      data.resize(*length);
+      if (!reader.bytes(data.data(), data.size())) {
+        return std::nullopt;
+      }
+    }
+
+    uint8_t trailer[4];
+    if (!stream.read(reinterpret_cast<char *>(trailer), sizeof(trailer))) {
+      return std::nullopt;
+    }
+    const uint32_t checksum = trailer[0] | trailer[1] << 8 | trailer[2] << 16 | static_cast<uint32_t>(trailer[3]) << 24;
+    if (checksum != reader.checksum()) {
+      return std::nullopt;
+    }
+    return snapshot;
+  }
+
+  bool ZnpNvSnapshot::save(const std::filesystem::path &path) const {
+    auto temporary_path = path;
+    temporary_path += ".tmp";
+    {
+      std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+      if (!file || !write(file) || !file.flush()) {
+        return false;
+      }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary_path, path, error);
+    return !error;
+  }
+
+  std::optional<ZnpNvSnapshot> ZnpNvSnapshot::load(const std::filesystem::path &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+      return std::nullopt;
+    }
+    return read(file);
+  }
+}
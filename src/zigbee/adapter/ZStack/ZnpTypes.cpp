@@ -1,5 +1,6 @@
 #include "zigbee/adapter/ZStack/ZnpTypes.hpp"
 
+#include <algorithm>
 #include <iomanip>
 #include <string>
 
@@ -7,17 +8,45 @@
 
 namespace lcl::zigbee::adapter::zstack {
   std::string IEEEAddress::toString() const {
-    return string_representation.value();
+    return std::format("{}", *this);
   }
 
   std::string ShortAddress::toString() const {
-    return string_representation.value();
+    return std::format("{}", *this);
+  }
+
+  ZnpFrameBuffer ZnpCommand::frame() const {
+    ZnpFrameBuffer frame;
+    frame.bytes[0] = SOF;
+    frame.bytes[1] = static_cast<uint8_t>(data.size());
+    frame.bytes[2] = static_cast<uint8_t>((type << 5 & 0xE0) | (subsystem & 0x1F));
+    frame.bytes[3] = commandId;
+
+    // The FCS is the XOR of everything after the SOF
+    uint8_t checksum = frame.bytes[1] ^ frame.bytes[2] ^ frame.bytes[3];
+    auto *out = frame.bytes.data() + 4;
+    for (const auto byte : data.bytes()) {
+      checksum ^= byte;
+      *out++ = byte;
+    }
+    *out++ = checksum;
+    frame.size = static_cast<std::size_t>(out - frame.bytes.data());
+    return frame;
+  }
+
+  ZnpResponseKey ZnpResponseKey::forRequest(const ZnpCommand &command) {
+    if (command.type == AREQ) {
+      return { command.subsystem, command.responseId, AREQ };
+    }
+    return { command.subsystem, command.commandId, SRSP };
   }
 
   EitherCmd<StatusableResponse> StatusableResponse::parse(const RawZnpResponse &response) {
-    auto typed_response = StatusableResponse { };
-    typed_response.status = response.payload[0] == 0;
-    return EitherCmd<StatusableResponse>::value(typed_response);
+    const ZnpPayloadReader payload(response.payload);
+    if (!payload.has(1)) {
+      return EitherCmd<StatusableResponse>::error({ response.command, "Response is missing its status" });
+    }
+    return EitherCmd<StatusableResponse>::value({ payload.u8(0) == 0 });
   }
 
   EitherCmd<StatusableResponse> StatusableResponse::success() {
@@ -29,55 +58,41 @@ namespace lcl::zigbee::adapter::zstack {
   }
 
   EitherCmd<SysOsalNvDeleteResponse> SysOsalNvDeleteResponse::parse(const RawZnpResponse &response) {
-    auto typed_response = SysOsalNvDeleteResponse { };
-    typed_response.status = static_cast<SysOsalNvDeleteStatus>(response.payload[0]);
-    return EitherCmd<SysOsalNvDeleteResponse>::value(typed_response);
+    const ZnpPayloadReader payload(response.payload);
+    if (!payload.has(1)) {
+      return EitherCmd<SysOsalNvDeleteResponse>::error({ SYS_OSAL_NV_DELETE, "Truncated SYS_OSAL_NV_DELETE response" });
+    }
+    return EitherCmd<SysOsalNvDeleteResponse>::value({ static_cast<SysOsalNvDeleteStatus>(payload.u8(0)) });
   }
 
-  EitherCmd<SysPingResponse> SysPingResponse::parse(const RawZnpResponse& response) {
-    auto typed_response = SysPingResponse { };
-    const auto capabilities = response.payload[0] << 8 | response.payload[1];
-    if ((MT_CAP_SYS & capabilities) == MT_CAP_SYS) {
-      typed_response.capabilities.emplace(MT_CAP_SYS);
-    }
-    if ((MT_CAP_MAC & capabilities) == MT_CAP_MAC) {
-      typed_response.capabilities.emplace(MT_CAP_MAC);
-    }
-    if ((MT_CAP_NWK & capabilities) == MT_CAP_NWK) {
-      typed_response.capabilities.emplace(MT_CAP_NWK);
-    }
-    if ((MT_CAP_AF & capabilities) == MT_CAP_AF) {
-      typed_response.capabilities.emplace(MT_CAP_AF);
-    }
-    if ((MT_CAP_ZDO & capabilities) == MT_CAP_ZDO) {
-      typed_response.capabilities.emplace(MT_CAP_ZDO);
-    }
-    if ((MT_CAP_SAPI & capabilities) == MT_CAP_SAPI) {
-      typed_response.capabilities.emplace(MT_CAP_SAPI);
-    }
-    if ((MT_CAP_UTIL & capabilities) == MT_CAP_UTIL) {
-      typed_response.capabilities.emplace(MT_CAP_UTIL);
-    }
-    if ((MT_CAP_DEBUG & capabilities) == MT_CAP_DEBUG) {
-      typed_response.capabilities.emplace(MT_CAP_DEBUG);
-    }
-    if ((MT_CAP_APP & capabilities) == MT_CAP_APP) {
-      typed_response.capabilities.emplace(MT_CAP_APP);
-    }
-    if ((MT_CAP_ZOAD & capabilities) == MT_CAP_ZOAD) {
-      typed_response.capabilities.emplace(MT_CAP_ZOAD);
+  EitherCmd<SysOsalNvItemInitResponse> SysOsalNvItemInitResponse::parse(const RawZnpResponse &response) {
+    const ZnpPayloadReader payload(response.payload);
+    if (!payload.has(1)) {
+      return EitherCmd<SysOsalNvItemInitResponse>::error({ SYS_OSAL_NV_ITEM_INIT, "Truncated SYS_OSAL_NV_ITEM_INIT response" });
     }
+    return EitherCmd<SysOsalNvItemInitResponse>::value({ static_cast<SysOsalNvItemInitStatus>(payload.u8(0)) });
+  }
 
-    return EitherCmd<SysPingResponse>::value(typed_response);
+  EitherCmd<SysPingResponse> SysPingResponse::parse(const RawZnpResponse& response) {
+    const ZnpPayloadReader payload(response.payload);
+    if (!payload.has(2)) {
+      return EitherCmd<SysPingResponse>::error({ SYS_PING, "Truncated SYS_PING response" });
+    }
+    return EitherCmd<SysPingResponse>::value({ ZnpCapabilities(payload.u16(0)) });
   }
 
   EitherCmd<SysVersionResponse> SysVersionResponse::parse(const RawZnpResponse &response) {
+    const ZnpPayloadReader payload(response.payload);
+    if (!payload.has(5)) {
+      return EitherCmd<SysVersionResponse>::error({ SYS_VERSION, "Truncated SYS_VERSION response" });
+    }
+
     auto typed_response = SysVersionResponse { };
-    typed_response.transport_protocol_revision = response.payload[0];
-    typed_response.product_id = response.payload[1];
-    typed_response.major_release = response.payload[2];
-    typed_response.minor_release = response.payload[3];
-    typed_response.maintenance_release = response.payload[4];
+    typed_response.transport_protocol_revision = payload.u8(0);
+    typed_response.product_id = payload.u8(1);
+    typed_response.major_release = payload.u8(2);
+    typed_response.minor_release = payload.u8(3);
+    typed_response.maintenance_release = payload.u8(4);
 
     return EitherCmd<SysVersionResponse>::value(typed_response);
   }
@@ -85,31 +100,46 @@ namespace lcl::zigbee::adapter::zstack {
   template<>
   EitherCmd<SysOsalNvReadResponse<std::vector<uint8_t>>> SysOsalNvReadResponse<std::vector<uint8_t>>::parse(const RawZnpResponse &result) {
     EitherCmd response = SysOsalNvReadResponse {};
+    if (result.payload.size() < 2) {
+      response->status = false;
+      return response;
+    }
     response->status = result.payload[0] == 0;
-    const auto length = result.payload[1];
-    response->data = std::vector<uint8_t>(length);
-    std::ranges::copy(result.payload.begin() + 2, result.payload.end(), response->data.begin());
+    // Never trust the length byte beyond what actually arrived
+    const auto length = std::min<std::size_t>(result.payload[1], result.payload.size() - 2);
+    response->data = std::vector<uint8_t>(result.payload.begin() + 2, result.payload.begin() + 2 + length);
     return response;
   }
 
   EitherCmd<SysResetCallback> SysResetCallback::parse(const RawZnpResponse& response) {
+    const ZnpPayloadReader payload(response.payload);
+    if (!payload.has(5)) {
+      return EitherCmd<SysResetCallback>::error({ SYS_RESET_IND, "Truncated SYS_RESET_IND" });
+    }
+
     auto typed_response = SysResetCallback { };
-    typed_response.reason = static_cast<SysResetReason>(response.payload[0]);
-    typed_response.transport_protocol_version = response.payload[1];
-    typed_response.major_release = response.payload[2];
-    typed_response.minor_release = response.payload[3];
-    typed_response.hardware_revision = response.payload[4];
+    typed_response.reason = static_cast<SysResetReason>(payload.u8(0));
+    typed_response.transport_protocol_version = payload.u8(1);
+    typed_response.major_release = payload.u8(2);
+    typed_response.minor_release = payload.u8(3);
+    typed_response.hardware_revision = payload.u8(4);
 
     return EitherCmd<SysResetCallback>::value(typed_response);
   }
 
   EitherCmd<SysOsalNvLengthResponse> SysOsalNvLengthResponse::parse(const RawZnpResponse& response) {
-    auto typed_response = SysOsalNvLengthResponse { };
-    typed_response.length = response.payload[1] << 8 | response.payload[0];
-    return EitherCmd<SysOsalNvLengthResponse>::value(typed_response);
+    const ZnpPayloadReader payload(response.payload);
+    if (!payload.has(2)) {
+      return EitherCmd<SysOsalNvLengthResponse>::error({ SYS_OSAL_NV_LENGTH, "Truncated SYS_OSAL_NV_LENGTH response" });
+    }
+    return EitherCmd<SysOsalNvLengthResponse>::value({ payload.u16(0) });
   }
 
   EitherCmd<ZnpStartupOptions> ZnpStartupOptions::parse(const std::vector<uint8_t>& buffer, const uint8_t offset, uint8_t length) {
+    if (length < 1 || offset >= buffer.size()) {
+      return EitherCmd<ZnpStartupOptions>::error({ SYS_OSAL_NV_READ, "Startup options item is empty" });
+    }
+
     auto typed_response = ZnpStartupOptions { };
     typed_response.clearNetworkFrameCounter = ZCD_STARTOPT_CLEAR_NWK_FRAME_COUNTER == (buffer[offset + 0] & ZCD_STARTOPT_CLEAR_NWK_FRAME_COUNTER);
     typed_response.clearNetworkState = ZCD_STARTOPT_CLEAR_STATE == (buffer[offset + 0] & ZCD_STARTOPT_CLEAR_STATE);
@@ -118,27 +148,28 @@ namespace lcl::zigbee::adapter::zstack {
   }
 
   EitherCmd<GetDeviceInfoResponse> GetDeviceInfoResponse::parse(const RawZnpResponse &response) {
+    // status, IEEE address, short address, device type, device state, associated device count
+    constexpr std::size_t HEADER_LENGTH = 1 + 8 + 2 + 1 + 1 + 1;
+
+    const ZnpPayloadReader payload(response.payload);
+    if (!payload.has(HEADER_LENGTH)) {
+      return EitherCmd<GetDeviceInfoResponse>::error({ UTIL_GET_DEVICE_INFO, "Truncated UTIL_GET_DEVICE_INFO response" });
+    }
+
     auto typed_response = GetDeviceInfoResponse { };
-    auto index = 0;
-    typed_response.status = response.payload.at(index++) == 0;
-
-    std::array<uint8_t, 8> ieee_address_buffer = {};
-    std::copy_n(response.payload.begin() + (index++), 8, ieee_address_buffer.begin());
-    typed_response.ieee_address = IEEEAddress(ieee_address_buffer);
-    index += 7;
-
-    std::array<uint8_t, 2> short_address_buffer = {};
-    std::copy_n(response.payload.begin() + (index++), 2, short_address_buffer.begin());
-    typed_response.short_address = ShortAddress(short_address_buffer);
-    index += 1;
-
-    typed_response.device_type = response.payload.at(index++);
-    typed_response.device_state = static_cast<DeviceState>(response.payload.at(index++));
-    typed_response.number_of_associated_devices = response.payload.at(index++);
-
-    for (std::vector<uint8_t>::size_type i = index; i < response.payload.size(); i += 2) {
-      const auto device_address = (response.payload.at(i + 1) << 8) | (response.payload.at(i) & 0xFF);
-      typed_response.associated_devices.push_back(device_address);
+    typed_response.status = payload.u8(0) == 0;
+    typed_response.ieee_address = IEEEAddress(payload.u64(1));
+    typed_response.short_address = ShortAddress(payload.u16(9));
+    typed_response.device_type = payload.u8(11);
+    typed_response.device_state = static_cast<DeviceState>(payload.u8(12));
+
+    // Only list the addresses that actually arrived, whatever the count claims
+    const auto listed = std::min({
+      static_cast<std::size_t>(payload.u8(13)), (payload.size() - HEADER_LENGTH) / 2, MAX_ASSOCIATED_DEVICES
+    });
+    typed_response.number_of_associated_devices = static_cast<uint8_t>(listed);
+    for (std::size_t i = 0; i < listed; i++) {
+      typed_response.associated_devices[i] = payload.u16(HEADER_LENGTH + i * 2);
     }
 
     return EitherCmd<GetDeviceInfoResponse>::value(typed_response);
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <thread>
+
+#include "asio/io_context.hpp"
+#include "asio/post.hpp"
+#include "async/asio_executor.hpp"
+#include "async/task.hpp"
+
+using namespace lcl::async;
+
+namespace {
+  // Runs an io_context on its own thread for the lifetime of the fixture
+  class running_io_context {
+  public:
+    asio::io_context io_context;
+
+  private:
+    asio::executor_work_guard<asio::io_context::executor_type> work_ = asio::make_work_guard(io_context);
+    std::thread thread_ { [this] { io_context.run(); } };
+
+  public:
+    ~running_io_context() {
+      work_.reset();
+      thread_.join();
+    }
+
+    [[nodiscard]] std::thread::id thread_id() const {
+      return thread_.get_id();
+    }
+  };
+}  // namespace
+
+TEST(AsioExecutorTest, ResolvingOnTheExecutorResumesInline) {
+  running_io_context context;
+  io_context_executor executor { context.io_context.get_executor() };
+
+  DeferredTask<int> response { executor };
+  auto resolver = response.get_resolver();
+  std::thread::id resumed_on;
+  // The state is passed as parameters rather than captured: the closure is a temporary that's gone once this coroutine
+  // first suspends, while its parameters live in the coroutine frame
+  auto awaiting = [](DeferredTask<int>& deferred, std::thread::id& resumed) -> Task<int> {
+    const auto value = co_await deferred;
+    resumed = std::this_thread::get_id();
+    co_return value;
+  }(response, resumed_on);
+
+  // The awaiter has already run by the time resolve returns, without a trip through the thread pool
+  std::binary_semaphore resolved { 0 };
+  bool resumed_before_returning = false;
+  asio::post(context.io_context, [&] {
+    resolver.resolve(42);
+    resumed_before_returning = awaiting.await_ready();
+    resolved.release();
+  });
+  resolved.acquire();
+
+  EXPECT_TRUE(resumed_before_returning);
+  EXPECT_EQ(sync_wait(awaiting), 42);
+  EXPECT_EQ(resumed_on, context.thread_id());
+}
+
+TEST(AsioExecutorTest, ResolvingElsewhereResumesOnTheExecutor) {
+  running_io_context context;
+  io_context_executor executor { context.io_context.get_executor() };
+
+  DeferredTask<void> signal { executor };
+  auto resolver = signal.get_resolver();
+  std::thread::id resumed_on;
+  auto awaiting = [](DeferredTask<void>& deferred, std::thread::id& resumed) -> Task<void> {
+    co_await deferred;
+    resumed = std::this_thread::get_id();
+  }(signal, resumed_on);
+
+  resolver.resolve();
+  sync_wait(awaiting);
+  EXPECT_EQ(resumed_on, context.thread_id());
+}
+
+TEST(AsioExecutorTest, ScheduleHopsOntoTheExecutor) {
+  running_io_context context;
+  io_context_strand_executor executor { asio::make_strand(context.io_context.get_executor()) };
+
+  auto hop = [&executor]() -> Task<std::thread::id> {
+    co_await executor.schedule();
+    co_return std::this_thread::get_id();
+  };
+
+  auto task = hop();
+  EXPECT_EQ(sync_wait(task), context.thread_id());
+}
@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+#include "async/combinators.hpp"
+#include "async/timer.hpp"
+#include "result/TaskEither.hpp"
+
+using namespace lcl::async;
+
+namespace {
+  enum CombinatorErrorCodes : uint8_t {
+    EC_COMBINATOR_FAILED
+  };
+
+  using TestError = lcl::Error<CombinatorErrorCodes, void>;
+
+  // Completes after the given delay; the timer service waits so it doesn't tie up a pool worker
+  Task<int> delayed(const int value, const int delay_ms) {
+    co_await sleep_for(std::chrono::milliseconds(delay_ms));
+    co_return value;
+  }
+
+  Task<int> failing(const int delay_ms) {
+    co_await delayed(0, delay_ms);
+    throw std::runtime_error("failed");
+  }
+}  // namespace
+
+TEST(CombinatorsTest, WhenAllReturnsResultsInArgumentOrder) {
+  auto task = when_all(delayed(1, 50), delayed(2, 10), delayed(3, 30));
+  EXPECT_EQ(sync_wait(task), std::make_tuple(1, 2, 3));
+}
+
+TEST(CombinatorsTest, WhenAllRunsTasksConcurrently) {
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<Task<int>> tasks;
+  for (int i = 0; i < 4; ++i) {
+    tasks.push_back(delayed(i, 200));
+  }
+  auto task = when_all(std::move(tasks));
+  EXPECT_EQ(sync_wait(task), (std::vector { 0, 1, 2, 3 }));
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(700));
+}
+
+TEST(CombinatorsTest, WhenAllWorksWithTaskEither) {
+  auto value = []() -> lcl::TaskEither<int, TestError> {
+    co_return lcl::Either<int, TestError>::value(7);
+  };
+  auto error = []() -> lcl::TaskEither<int, TestError> {
+    co_return lcl::Either<int, TestError>::error({ EC_COMBINATOR_FAILED, "nope" });
+  };
+
+  auto task = when_all(value(), error());
+  const auto [first, second] = sync_wait(task);
+  ASSERT_TRUE(first);
+  EXPECT_EQ(*first, 7);
+  EXPECT_FALSE(second);
+}
+
+TEST(CombinatorsTest, WhenAllRethrowsFailures) {
+  auto task = when_all(delayed(1, 10), failing(20));
+  EXPECT_THROW(sync_wait(task), std::runtime_error);
+}
+
+TEST(CombinatorsTest, WhenAnyReturnsTheFirstToComplete) {
+  std::array<DeferredTask<int>, 3> deferred {};
+  auto await_deferred = [](DeferredTask<int>& dt) -> Task<int> {
+    co_return co_await dt;
+  };
+
+  std::vector<Task<int>> tasks;
+  for (auto& dt : deferred) {
+    tasks.push_back(await_deferred(dt));
+  }
+  auto task = when_any(std::move(tasks));
+
+  deferred[1].get_resolver().resolve(2);
+  const auto first = sync_wait(task);
+  EXPECT_EQ(first.index, 1u);
+  EXPECT_EQ(first.value, 2);
+
+  // The losers still finish; their results are dropped
+  deferred[0].get_resolver().resolve(1);
+  deferred[2].get_resolver().resolve(3);
+}
+
+TEST(CombinatorsTest, WhenAnyRejectsEmptyInput) {
+  auto task = when_any(std::vector<Task<int>>{});
+  EXPECT_THROW(sync_wait(task), std::invalid_argument);
+}
+
+TEST(CombinatorsTest, ForEachAsyncBoundsConcurrency) {
+  std::array<int, 16> items {};
+  for (int i = 0; i < 16; ++i) items[i] = i;
+
+  std::atomic<int> in_flight{0};
+  std::atomic<int> peak{0};
+  auto task = for_each_async(items, 3, [&](const int item) -> Task<int> {
+    const auto now = in_flight.fetch_add(1) + 1;
+    for (auto seen = peak.load(); now > seen && !peak.compare_exchange_weak(seen, now);) {}
+    const auto value = co_await delayed(item * 2, 10);
+    in_flight.fetch_sub(1);
+    co_return value;
+  });
+
+  const auto results = sync_wait(task);
+  ASSERT_EQ(results.size(), items.size());
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_EQ(results[i], i * 2);
+  }
+  EXPECT_LE(peak.load(), 3);
+}
+
+TEST(CombinatorsTest, ForEachAsyncWaitsForEveryItemBeforeFailing) {
+  std::array items { 0, 1, 2, 3, 4, 5 };
+  std::atomic<int> completed{0};
+  auto task = for_each_async(items, 2, [&](const int item) -> Task<void> {
+    co_await delayed(item, 10);
+    completed.fetch_add(1);
+    if (item == 1) throw std::runtime_error("failed");
+  });
+
+  EXPECT_THROW(sync_wait(task), std::runtime_error);
+  EXPECT_EQ(completed.load(), 6);
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+
+#include "async/single_flight.hpp"
+
+using namespace lcl::async;
+using namespace std::chrono_literals;
+
+TEST(SingleFlightTest, ConcurrentCallersShareOneRun) {
+  single_flight<int> flight;
+  std::atomic<int> runs{0};
+  DeferredTask<int> response;
+  auto query = [&runs, &response]() -> Task<int> {
+    runs++;
+    co_return co_await response;
+  };
+
+  auto first = flight.run(query, 0s);
+  auto second = flight.run(query, 0s);
+  response.get_resolver().resolve(7);
+
+  EXPECT_EQ(sync_wait(first), 7);
+  EXPECT_EQ(sync_wait(second), 7);
+  EXPECT_EQ(runs, 1);
+}
+
+TEST(SingleFlightTest, ReusesResultsUntilTheyExpire) {
+  single_flight<int> flight;
+  std::atomic<int> runs{0};
+  auto query = [&runs]() -> Task<int> {
+    co_return ++runs;
+  };
+
+  auto first = flight.run(query, 50ms);
+  auto second = flight.run(query, 50ms);
+  EXPECT_EQ(sync_wait(first), 1);
+  EXPECT_EQ(sync_wait(second), 1);
+
+  std::this_thread::sleep_for(60ms);
+  auto expired = flight.run(query, 50ms);
+  EXPECT_EQ(sync_wait(expired), 2);
+
+  flight.invalidate();
+  auto invalidated = flight.run(query, single_flight<int>::clock::duration::max());
+  EXPECT_EQ(sync_wait(invalidated), 3);
+}
+
+TEST(SingleFlightTest, DoesNotCacheRejectedResultsOrFailures) {
+  single_flight<int> flight([](const int& result) { return result > 0; });
+  std::atomic<int> runs{0};
+  auto query = [&runs]() -> Task<int> {
+    co_return runs++;
+  };
+
+  auto rejected = flight.run(query, 1s);
+  EXPECT_EQ(sync_wait(rejected), 0);
+  auto accepted = flight.run(query, 1s);
+  EXPECT_EQ(sync_wait(accepted), 1);
+
+  single_flight<int> failing;
+  DeferredTask<int> response;
+  auto throwing = [&response]() -> Task<int> {
+    co_return co_await response;
+  };
+  auto leader = failing.run(throwing, 1s);
+  auto follower = failing.run(throwing, 1s);
+  response.get_resolver().reject(std::runtime_error("no response"));
+  EXPECT_THROW(sync_wait(leader), std::runtime_error);
+  EXPECT_THROW(sync_wait(follower), std::runtime_error);
+}
+
+TEST(SingleFlightTest, CallersAfterAnInvalidateStartAFreshRun) {
+  single_flight<int> flight;
+  std::atomic<int> runs{0};
+  DeferredTask<int> stale_response;
+  auto stale_query = [&runs, &stale_response]() -> Task<int> {
+    runs++;
+    co_return co_await stale_response;
+  };
+  auto fresh_query = [&runs]() -> Task<int> {
+    co_return ++runs * 10;
+  };
+
+  auto stale = flight.run(stale_query, single_flight<int>::clock::duration::max());
+  flight.invalidate();
+  auto fresh = flight.run(fresh_query, single_flight<int>::clock::duration::max());
+  EXPECT_EQ(sync_wait(fresh), 20);
+
+  stale_response.get_resolver().resolve(1);
+  EXPECT_EQ(sync_wait(stale), 1);
+
+  // The fresh run's result is the one kept
+  auto cached = flight.run(stale_query, single_flight<int>::clock::duration::max());
+  EXPECT_EQ(sync_wait(cached), 20);
+  EXPECT_EQ(runs, 2);
+}
@@ -189,4 +189,223 @@ TEST(AsyncTest, CanAwaitTaskEitherFunction) {
   task.await_ready();
   ASSERT_FALSE(task.handle_.promise().exception_);
   EXPECT_EQ(*task.handle_.promise().value_.value(), true);
-}
\ No newline at end of file
+}
+
+TEST(AsyncTest, CanAwaitTaskSuspendedOnDeferredTask) {
+  DeferredTask<int> dt{};
+  auto resolver = dt.get_resolver();
+
+  auto inner = [&dt]() -> Task<int> {
+    const int val = co_await dt;
+    co_return val + 1;
+  };
+  auto outer = [&inner]() -> Task<int> {
+    co_return co_await inner();
+  };
+
+  auto task = outer();
+  get_thread_pool().enqueue([&resolver] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    resolver.resolve(41);
+  });
+
+  EXPECT_EQ(sync_wait(task), 42);
+}
+
+TEST(AsyncTest, ThreadPoolResumesEveryScheduledCoroutine) {
+  thread_pool pool{4};
+  std::atomic<int> resumes{0};
+  constexpr int chains = 64;
+  constexpr int hops = 100;
+
+  auto chain = [&pool, &resumes]() -> Task<void> {
+    for (int i = 0; i < hops; ++i) {
+      co_await pool.schedule();
+      resumes.fetch_add(1);
+    }
+  };
+
+  std::vector<Task<void>> tasks;
+  for (int i = 0; i < chains; ++i) {
+    tasks.push_back(chain());
+  }
+  for (auto& task : tasks) {
+    sync_wait(task);
+  }
+
+  EXPECT_EQ(resumes.load(), chains * hops);
+}
+
+TEST(AsyncTest, ThreadPoolLetsIdleWorkersTakeWorkFromABlockedWorker) {
+  thread_pool pool{2};
+  std::binary_semaphore inner_done{0};
+  std::binary_semaphore outer_done{0};
+  std::atomic<bool> inner_ran{false};
+
+  pool.enqueue([&pool, &inner_done, &outer_done, &inner_ran] {
+    pool.enqueue([&inner_done, &inner_ran] {
+      inner_ran.store(true);
+      inner_done.release();
+    });
+    // Blocks the worker that scheduled the inner task; only a sibling can run it
+    inner_done.try_acquire_for(std::chrono::seconds(5));
+    outer_done.release();
+  });
+
+  outer_done.acquire();
+  EXPECT_TRUE(inner_ran.load());
+}
+
+TEST(AsyncTest, ThreadPoolRunsInlineAndBoxedWork) {
+  thread_pool pool{2};
+  std::atomic<int> runs{0};
+  std::binary_semaphore inline_done{0};
+  std::binary_semaphore boxed_done{0};
+
+  // Fits in the work item's inline storage
+  auto small = [&runs, &inline_done] {
+    runs.fetch_add(1);
+    inline_done.release();
+  };
+  static_assert(work_item::fits_inline<decltype(small)>);
+  pool.enqueue(small);
+
+  // Owns a shared_ptr, so it's boxed
+  auto counter = std::make_shared<int>(41);
+  auto large = [counter, &runs, &boxed_done] {
+    runs.fetch_add(*counter);
+    boxed_done.release();
+  };
+  static_assert(!work_item::fits_inline<decltype(large)>);
+  pool.enqueue(large);
+
+  inline_done.acquire();
+  boxed_done.acquire();
+  EXPECT_EQ(runs.load(), 42);
+}
+
+TEST(AsyncTest, LazyTaskDoesNotStartUntilAwaited) {
+  bool started = false;
+  auto lazy = [&started]() -> LazyTask<int> {
+    started = true;
+    co_return 42;
+  };
+
+  auto task = lazy();
+  EXPECT_FALSE(started);
+  EXPECT_EQ(sync_wait(task), 42);
+  EXPECT_TRUE(started);
+}
+
+TEST(AsyncTest, LazyTaskPropagatesExceptions) {
+  auto lazy = []() -> LazyTask<void> {
+    throw std::runtime_error("lazy failure");
+    co_return;
+  };
+
+  auto task = lazy();
+  EXPECT_THROW(sync_wait(task), std::runtime_error);
+}
+
+TEST(AsyncTest, LazyTaskChainsResumeInline) {
+  // Every level completes synchronously and hands control straight back to its awaiter on the same thread
+  auto leaf = []() -> LazyTask<std::thread::id> {
+    co_return std::this_thread::get_id();
+  };
+  auto chain = [&leaf]() -> LazyTask<int> {
+    const auto caller = std::this_thread::get_id();
+    int inline_resumes = 0;
+    for (int i = 0; i < 10'000; ++i) {
+      if (co_await leaf() == caller && std::this_thread::get_id() == caller) {
+        inline_resumes++;
+      }
+    }
+    co_return inline_resumes;
+  };
+
+  auto task = chain();
+  EXPECT_EQ(sync_wait(task), 10'000);
+}
+
+TEST(AsyncTest, LazyTaskFramesAreReusedFromTheFramePool) {
+  auto lazy = []() -> LazyTask<int> {
+    co_return 1;
+  };
+  {
+    // Destroying the unstarted task returns its frame to this thread's cache
+    auto warm = lazy();
+  }
+
+  const auto before = frame_pool::local_statistics();
+  {
+    auto reused = lazy();
+  }
+  const auto after = frame_pool::local_statistics();
+
+  EXPECT_EQ(after.allocations - before.allocations, 1u);
+  EXPECT_EQ(after.pool_hits - before.pool_hits, 1u);
+  EXPECT_EQ(after.deallocations - before.deallocations, 1u);
+}
+
+TEST(AsyncTest, FramePoolSendsOversizedFramesToTheHeap) {
+  const auto before = frame_pool::local_statistics();
+  void* frame = frame_pool::allocate(frame_pool::max_block + 1);
+  frame_pool::deallocate(frame, frame_pool::max_block + 1);
+  const auto after = frame_pool::local_statistics();
+
+  EXPECT_EQ(after.oversized_allocations - before.oversized_allocations, 1u);
+  EXPECT_EQ(after.cached_blocks, before.cached_blocks);
+}
+
+#ifndef NDEBUG
+namespace {
+  // Frames finishing on a pool thread are destroyed just after the awaiter is released
+  void wait_for_live_frames(const std::int64_t expected) {
+    const auto start = std::chrono::steady_clock::now();
+    while (pooled_frame::live_frames() > expected) {
+      if (std::chrono::steady_clock::now() - start > std::chrono::seconds(5)) {
+        FAIL() << "Timeout waiting for frames to be destroyed";
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  }
+}  // namespace
+
+TEST(AsyncTest, CompletedTasksDestroyTheirFrames) {
+  const auto before = pooled_frame::live_frames();
+  {
+    DeferredTask<int> dt{};
+    auto resolver = dt.get_resolver();
+    auto inner = [&dt]() -> Task<int> {
+      co_return co_await dt;
+    };
+    auto outer = [&inner]() -> Task<int> {
+      co_return co_await inner();
+    };
+
+    auto task = outer();
+    resolver.resolve(7);
+    EXPECT_EQ(sync_wait(task), 7);
+  }
+  wait_for_live_frames(before);
+  EXPECT_EQ(pooled_frame::live_frames(), before);
+}
+
+TEST(AsyncTest, DetachedTasksDestroyTheirFramesWhenTheyFinish) {
+  const auto before = pooled_frame::live_frames();
+  DeferredTask<void> dt{};
+  auto resolver = dt.get_resolver();
+  std::atomic<bool> finished{false};
+
+  [](DeferredTask<void>& awaited, std::atomic<bool>& done) -> Task<void> {
+    co_await awaited;
+    done = true;
+  }(dt, finished).detach();
+  EXPECT_EQ(pooled_frame::live_frames(), before + 1);
+
+  resolver.resolve();
+  wait_for_live_frames(before);
+  EXPECT_TRUE(finished);
+  EXPECT_EQ(pooled_frame::live_frames(), before);
+}
+#endif
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <stop_token>
+
+#include "async/timeout.hpp"
+
+using namespace lcl::async;
+using namespace std::chrono_literals;
+
+TEST(TimeoutTest, SleepForResumesAfterTheDelay) {
+  auto sleeper = []() -> Task<void> {
+    co_await sleep_for(50ms);
+  };
+
+  const auto start = std::chrono::steady_clock::now();
+  auto task = sleeper();
+  sync_wait(task);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, 50ms);
+}
+
+TEST(TimeoutTest, CancelledTimersNeverFire) {
+  std::atomic<bool> fired{false};
+  const auto timer = get_timer_service().schedule_after(20ms, [&fired] { fired = true; });
+  EXPECT_TRUE(get_timer_service().cancel(timer));
+  EXPECT_FALSE(get_timer_service().cancel(timer));
+
+  std::this_thread::sleep_for(60ms);
+  EXPECT_FALSE(fired);
+}
+
+TEST(TimeoutTest, WithTimeoutReturnsResultsThatArriveInTime) {
+  auto quick = []() -> Task<int> {
+    co_await sleep_for(10ms);
+    co_return 42;
+  };
+
+  auto task = with_timeout(quick(), 1s);
+  EXPECT_EQ(sync_wait(task), 42);
+}
+
+TEST(TimeoutTest, WithTimeoutThrowsOnceTheDeadlinePasses) {
+  // Never resolved
+  DeferredTask<int> never{};
+  auto stuck = [&never]() -> Task<int> {
+    co_return co_await never;
+  };
+
+  const auto start = std::chrono::steady_clock::now();
+  auto task = with_timeout(stuck(), 50ms);
+  EXPECT_THROW(sync_wait(task), timeout_error);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, 1s);
+
+  // Release the abandoned awaiter so its frame is freed
+  never.get_resolver().resolve(0);
+}
+
+TEST(TimeoutTest, WithTimeoutRequestsStopOnTheOperation) {
+  auto cancellable = [](const std::stop_token token) -> Task<void> {
+    DeferredTask<void> forever{};
+    forever.get_resolver().cancel_on(token);
+    co_await forever;
+  };
+
+  auto task = with_timeout(cancellable, 50ms);
+  EXPECT_THROW(sync_wait(task), timeout_error);
+}
+
+TEST(TimeoutTest, CancelOnRejectsWithCancelledError) {
+  std::stop_source stop;
+  DeferredTask<int> dt{};
+  dt.get_resolver().cancel_on(stop.get_token());
+
+  auto waiter = [&dt]() -> Task<int> {
+    co_return co_await dt;
+  };
+  auto task = waiter();
+  stop.request_stop();
+  EXPECT_THROW(sync_wait(task), cancelled_error);
+}
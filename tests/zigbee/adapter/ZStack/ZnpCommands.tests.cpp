@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "zigbee/adapter/ZStack/ZnpCommandDescriptors.hpp"
+#include "zigbee/adapter/ZStack/ZnpCommands.hpp"
+
+using namespace lcl::zigbee::adapter::zstack;
+
+namespace {
+  std::vector<uint8_t> wire(const ZnpCommand &command) {
+    const auto frame = command.frame();
+    return { frame.view().begin(), frame.view().end() };
+  }
+}  // namespace
+
+TEST(ZnpCommandsTest, FramesCommandsWithoutAPayload) {
+  EXPECT_EQ(wire(sysPing()), std::vector<uint8_t>({ SOF, 0x00, 0x21, 0x01, 0x20 }));
+}
+
+TEST(ZnpCommandsTest, FramesThePayloadAndChecksum) {
+  EXPECT_EQ(wire(sysOsalNvLength(ZCD_NV_PAN_ID)), std::vector<uint8_t>({ SOF, 0x02, 0x21, 0x13, 0x83, 0x00, 0xB3 }));
+}
+
+TEST(ZnpCommandsTest, CopiesOnlyTheRequestedChunk) {
+  const std::vector<uint8_t> item(300, 0xAB);
+  const auto command = sysOsalNvWriteExt(ZCD_NV_NIB, 244, item.begin() + 244, item.end());
+
+  ASSERT_EQ(command.data.size(), 6 + 56);
+  EXPECT_EQ(command.data.bytes()[2], 244);
+  EXPECT_EQ(command.data.bytes()[4], 56);
+  EXPECT_EQ(command.frame().size, ZNP_FRAME_OVERHEAD + 6 + 56);
+}
+
+TEST(ZnpCommandsTest, RefusesPayloadsLargerThanAFrame) {
+  const std::vector<uint8_t> item(ZNP_MAX_PAYLOAD_LENGTH, 0x00);
+  EXPECT_THROW(sysOsalNvWriteExt(ZCD_NV_NIB, 0, item.begin(), item.end()), std::length_error);
+}
+
+TEST(ZnpCommandsTest, TakesTypeAndResponseFromTheDescriptorTable) {
+  static_assert(describeCommand(SUBSYSTEM_SYS, SYS_RESET_REQ).response == SYS_RESET_IND);
+
+  const auto reset = sysResetReq();
+  EXPECT_EQ(reset.type, AREQ);
+  EXPECT_EQ(reset.responseId, SYS_RESET_IND);
+
+  const auto channels = utilSetChannels(ZNP_CHANNEL_MASK_11);
+  EXPECT_EQ(channels.type, SREQ);
+  EXPECT_EQ(channels.commandId, UTIL_SET_CHANNELS);
+  EXPECT_EQ(utilGetDeviceInfo().minimumResponseLength, 14);
+}
+
+TEST(ZnpCommandsTest, RefusesPayloadsThatDontMatchTheLayout) {
+  EXPECT_THROW((makeCommand<SUBSYSTEM_SYS, SYS_OSAL_NV_LENGTH>(ZnpPayload(3))), std::length_error);
+  EXPECT_THROW((makeCommand<SUBSYSTEM_SYS, SYS_OSAL_NV_WRITE>(ZnpPayload(3))), std::length_error);
+  EXPECT_NO_THROW((makeCommand<SUBSYSTEM_SYS, SYS_OSAL_NV_WRITE>(ZnpPayload(12))));
+}
+
+TEST(ZnpCommandsTest, SplitsNvItemsIntoContiguousChunks) {
+  EXPECT_EQ(nvChunks(0, 10, ZNP_NV_WRITE_EXT_CHUNK_LENGTH), std::vector<ZnpNvChunk>({ { 0, 10 } }));
+  EXPECT_EQ(nvChunks(0, 300, ZNP_NV_WRITE_EXT_CHUNK_LENGTH), std::vector<ZnpNvChunk>({ { 0, 244 }, { 244, 300 } }));
+  EXPECT_EQ(nvChunks(0, 300, ZNP_NV_WRITE_CHUNK_LENGTH), std::vector<ZnpNvChunk>({ { 0, 246 }, { 246, 300 } }));
+
+  // Continuing after SYS_OSAL_NV_ITEM_INIT carried the first bytes
+  const auto chunks = nvChunks(ZNP_NV_ITEM_INIT_CHUNK_LENGTH, 1000, ZNP_NV_WRITE_EXT_CHUNK_LENGTH);
+  ASSERT_EQ(chunks.size(), 4);
+  EXPECT_EQ(chunks.front().begin, ZNP_NV_ITEM_INIT_CHUNK_LENGTH);
+  for (std::size_t i = 1; i < chunks.size(); i++) {
+    EXPECT_EQ(chunks[i].begin, chunks[i - 1].end);
+    EXPECT_EQ(chunks[i - 1].end - chunks[i - 1].begin, ZNP_NV_WRITE_EXT_CHUNK_LENGTH);
+  }
+  EXPECT_EQ(chunks.back().end, 1000);
+}
+
+TEST(ZnpCommandsTest, RejectsChunksStartingPastTheShortOffsetLimit) {
+  // An existing item written from offset 0: the third chunk would start at 492
+  EXPECT_TRUE(nvChunksFitShortOffsets(nvChunks(0, 492, ZNP_NV_WRITE_CHUNK_LENGTH)));
+  EXPECT_FALSE(nvChunksFitShortOffsets(nvChunks(0, 493, ZNP_NV_WRITE_CHUNK_LENGTH)));
+
+  // A freshly initialised item continues from the bytes SYS_OSAL_NV_ITEM_INIT carried
+  EXPECT_TRUE(nvChunksFitShortOffsets(nvChunks(ZNP_NV_ITEM_INIT_CHUNK_LENGTH, 491, ZNP_NV_WRITE_CHUNK_LENGTH)));
+  EXPECT_FALSE(nvChunksFitShortOffsets(nvChunks(ZNP_NV_ITEM_INIT_CHUNK_LENGTH, 492, ZNP_NV_WRITE_CHUNK_LENGTH)));
+
+  // The last addressable offset itself is fine
+  EXPECT_TRUE(nvChunksFitShortOffsets({ { 0xFF, 0x100 } }));
+  EXPECT_FALSE(nvChunksFitShortOffsets({ { 0x100, 0x101 } }));
+}
+
+TEST(ZnpCommandsTest, ProducesNoChunksForNothingLeftToTransfer) {
+  EXPECT_TRUE(nvChunks(0, 0, ZNP_NV_WRITE_CHUNK_LENGTH).empty());
+  EXPECT_TRUE(nvChunks(300, 300, ZNP_NV_WRITE_CHUNK_LENGTH).empty());
+  EXPECT_THROW(nvChunks(0, 10, 0), std::invalid_argument);
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "zigbee/adapter/ZStack/ZnpDispatcher.hpp"
+
+using namespace lcl::zigbee::adapter::zstack;
+
+namespace {
+  const ZnpCallbackKey STATE_CHANGE { SUBSYSTEM_ZDO, ZDO_STATE_CHANGE_IND };
+
+  RawZnpResponse stateChange(const uint8_t state) {
+    return RawZnpResponse { ZDO_STATE_CHANGE_IND, SUBSYSTEM_ZDO, AREQ, { state } };
+  }
+}  // namespace
+
+TEST(ZnpDispatcherTest, CountsFramesNobodyListensFor) {
+  ZnpDispatcher dispatcher;
+  EXPECT_FALSE(dispatcher.dispatch(stateChange(0x09)));
+  EXPECT_EQ(dispatcher.statistics().frames_unhandled, 1);
+  EXPECT_EQ(dispatcher.statistics().frames_dispatched, 0);
+}
+
+TEST(ZnpDispatcherTest, CallsHandlersUntilRemoved) {
+  ZnpDispatcher dispatcher;
+  std::vector<uint8_t> states;
+  const auto handler_id = dispatcher.addHandler(STATE_CHANGE, [&states](const RawZnpResponse &frame) {
+    states.push_back(frame.payload[0]);
+  });
+
+  EXPECT_TRUE(dispatcher.dispatch(stateChange(0x08)));
+  EXPECT_FALSE(dispatcher.dispatch(RawZnpResponse { AF_INCOMING_MSG, SUBSYSTEM_AF, AREQ, {} }));
+  dispatcher.removeHandler(handler_id);
+  EXPECT_FALSE(dispatcher.dispatch(stateChange(0x09)));
+
+  EXPECT_EQ(states, std::vector<uint8_t>({ 0x08 }));
+}
+
+TEST(ZnpDispatcherTest, SubscriptionsDropTheOldestFrameWhenFull) {
+  ZnpDispatcher dispatcher;
+  const auto subscription = dispatcher.subscribe(STATE_CHANGE, 2);
+  for (uint8_t state = 1; state <= 3; state++) {
+    dispatcher.dispatch(stateChange(state));
+  }
+
+  EXPECT_EQ(subscription->size(), 2);
+  EXPECT_EQ(subscription->dropped(), 1);
+  EXPECT_EQ(dispatcher.statistics().frames_dropped, 1);
+  EXPECT_EQ(subscription->tryNext()->payload[0], 2);
+  EXPECT_EQ(subscription->tryNext()->payload[0], 3);
+  EXPECT_FALSE(subscription->tryNext().has_value());
+}
+
+TEST(ZnpDispatcherTest, SubscriptionWakesAWaitingReader) {
+  ZnpDispatcher dispatcher;
+  const auto subscription = dispatcher.subscribe(STATE_CHANGE);
+
+  auto reader = [&subscription]() -> lcl::async::Task<RawZnpResponse> {
+    co_return co_await subscription->next();
+  }();
+  dispatcher.dispatch(stateChange(0x09));
+
+  EXPECT_EQ(lcl::async::sync_wait(reader).payload[0], 0x09);
+  EXPECT_EQ(subscription->size(), 0);
+}
+
+TEST(ZnpDispatcherTest, ReleasedSubscriptionsStopReceiving) {
+  ZnpDispatcher dispatcher;
+  {
+    const auto subscription = dispatcher.subscribe(STATE_CHANGE);
+    EXPECT_TRUE(dispatcher.dispatch(stateChange(0x08)));
+  }
+  EXPECT_FALSE(dispatcher.dispatch(stateChange(0x09)));
+  EXPECT_EQ(dispatcher.statistics().frames_unhandled, 1);
+}
@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+
+#include "zigbee/adapter/ZStack/ZnpFingerprint.hpp"
+
+using namespace lcl::zigbee::adapter::zstack;
+
+namespace {
+  const IEEEAddress ADAPTER_ADDRESS { { 0x00, 0x12, 0x4B, 0x00, 0x21, 0x4C, 0x3D, 0x8E } };
+  const SysVersionResponse ADAPTER_VERSION { 2, ZNP_VERSION_ZSTACK_3x0, 2, 7, 1 };
+
+  ZnpFingerprint fingerprint() {
+    return ZnpFingerprint {
+      ADAPTER_ADDRESS.toString(),
+      ADAPTER_VERSION,
+      { MT_CAP_SYS, MT_CAP_AF, MT_CAP_ZDO, MT_CAP_UTIL, MT_CAP_APP },
+      ZNP_MEMORY_ALIGNMENT_ALIGNED,
+      { { ZCD_NV_NWKKEY, 24 } }
+    };
+  }
+
+  std::filesystem::path statePath(const std::string &name) {
+    const auto path = std::filesystem::temp_directory_path() / ("lcl-" + name + ".state");
+    std::filesystem::remove(path);
+    return path;
+  }
+}  // namespace
+
+TEST(ZnpFingerprintTest, RoundTripsThroughTheStateFile) {
+  const auto path = statePath("round-trip");
+  ASSERT_TRUE(fingerprint().save(path));
+
+  const auto loaded = ZnpFingerprint::load(path);
+  ASSERT_TRUE(loaded.has_value());
+  EXPECT_EQ(loaded->ieee_address, ADAPTER_ADDRESS.toString());
+  EXPECT_EQ(loaded->version.product_id, ZNP_VERSION_ZSTACK_3x0);
+  EXPECT_EQ(loaded->version.maintenance_release, 1);
+  EXPECT_EQ(loaded->capabilities, fingerprint().capabilities);
+  EXPECT_EQ(loaded->memory_alignment, ZNP_MEMORY_ALIGNMENT_ALIGNED);
+  EXPECT_EQ(loaded->item_lengths, fingerprint().item_lengths);
+  EXPECT_TRUE(loaded->matches(ADAPTER_ADDRESS, ADAPTER_VERSION));
+  std::filesystem::remove(path);
+}
+
+TEST(ZnpFingerprintTest, DoesNotMatchAnotherAdapterOrFirmware) {
+  const auto saved = fingerprint();
+  EXPECT_FALSE(saved.matches(IEEEAddress { { 0x00, 0x12, 0x4B, 0x00, 0x21, 0x4C, 0x3D, 0x8F } }, ADAPTER_VERSION));
+
+  auto upgraded = ADAPTER_VERSION;
+  upgraded.minor_release++;
+  EXPECT_FALSE(saved.matches(ADAPTER_ADDRESS, upgraded));
+}
+
+TEST(ZnpFingerprintTest, IgnoresMissingOrForeignStateFiles) {
+  const auto path = statePath("foreign");
+  EXPECT_FALSE(ZnpFingerprint::load(path).has_value());
+
+  std::ofstream(path) << "format=99\nieee_address=00124b00214c3d8e\n";
+  EXPECT_FALSE(ZnpFingerprint::load(path).has_value());
+
+  std::ofstream(path, std::ios::trunc) << "format=1\nieee_address=00124b00214c3d8e\nversion=2.1\n";
+  EXPECT_FALSE(ZnpFingerprint::load(path).has_value());
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "zigbee/adapter/ZStack/ZnpFrameDecoder.hpp"
+
+using namespace lcl::zigbee::adapter::zstack;
+
+namespace {
+  // SYS_PING SRSP with capabilities 0x0659
+  const std::vector<uint8_t> PING_RESPONSE { 0xFE, 0x02, 0x61, 0x01, 0x59, 0x06, 0x3D };
+
+  // SYS_RESET_IND
+  const std::vector<uint8_t> RESET_INDICATION { 0xFE, 0x06, 0x41, 0x80, 0x00, 0x02, 0x01, 0x02, 0x07, 0x01, 0xC0 };
+}  // namespace
+
+TEST(ZnpFrameDecoderTest, DecodesCompleteFrame) {
+  ZnpFrameDecoder decoder;
+  EXPECT_EQ(decoder.write(PING_RESPONSE), PING_RESPONSE.size());
+
+  const auto frame = decoder.next();
+  ASSERT_TRUE(frame.has_value());
+  EXPECT_EQ(frame->command, SYS_PING);
+  EXPECT_EQ(frame->subsystem, SUBSYSTEM_SYS);
+  EXPECT_EQ(frame->type, SRSP);
+  EXPECT_EQ(frame->materialize().payload, std::vector<uint8_t>({ 0x59, 0x06 }));
+  EXPECT_FALSE(decoder.next().has_value());
+  EXPECT_EQ(decoder.size(), 0);
+}
+
+TEST(ZnpFrameDecoderTest, WaitsForSplitFrame) {
+  ZnpFrameDecoder decoder;
+  decoder.write(std::span(PING_RESPONSE).first(5));
+  EXPECT_FALSE(decoder.next().has_value());
+
+  decoder.write(std::span(PING_RESPONSE).subspan(5));
+  const auto frame = decoder.next();
+  ASSERT_TRUE(frame.has_value());
+  EXPECT_EQ(frame->command, SYS_PING);
+}
+
+TEST(ZnpFrameDecoderTest, DecodesBackToBackFrames) {
+  ZnpFrameDecoder decoder;
+  auto bytes = PING_RESPONSE;
+  bytes.insert(bytes.end(), RESET_INDICATION.begin(), RESET_INDICATION.end());
+  decoder.write(bytes);
+
+  const auto first = decoder.next();
+  ASSERT_TRUE(first.has_value());
+  EXPECT_EQ(first->command, SYS_PING);
+
+  const auto second = decoder.next();
+  ASSERT_TRUE(second.has_value());
+  EXPECT_EQ(second->command, SYS_RESET_IND);
+  EXPECT_EQ(second->type, AREQ);
+  EXPECT_EQ(second->payload.size(), 6);
+}
+
+TEST(ZnpFrameDecoderTest, DropsFrameWithBadChecksum) {
+  ZnpFrameDecoder decoder;
+  auto corrupt = PING_RESPONSE;
+  corrupt[4] ^= 0x01;
+  decoder.write(corrupt);
+  decoder.write(RESET_INDICATION);
+
+  const auto frame = decoder.next();
+  ASSERT_TRUE(frame.has_value());
+  EXPECT_EQ(frame->command, SYS_RESET_IND);
+}
+
+TEST(ZnpFrameDecoderTest, DecodesFramesWrappingTheRing) {
+  ZnpFrameDecoder decoder;
+  for (std::size_t i = 0; i < ZnpFrameDecoder::CAPACITY; i++) {
+    decoder.write(RESET_INDICATION);
+    const auto frame = decoder.next();
+    ASSERT_TRUE(frame.has_value());
+    EXPECT_EQ(frame->materialize().payload, std::vector<uint8_t>({ 0x00, 0x02, 0x01, 0x02, 0x07, 0x01 }));
+  }
+}
+
+TEST(ZnpFrameDecoderTest, ResynchronizesAfterLineNoise) {
+  ZnpFrameDecoder decoder;
+  decoder.write(std::vector<uint8_t>({ 0x00, 0x13 }));
+  decoder.write(PING_RESPONSE);
+
+  const auto frame = decoder.next();
+  ASSERT_TRUE(frame.has_value());
+  EXPECT_EQ(frame->command, SYS_PING);
+  EXPECT_EQ(decoder.statistics().bytes_discarded, 2);
+  EXPECT_EQ(decoder.statistics().frames_decoded, 1);
+}
+
+TEST(ZnpFrameDecoderTest, RecoversFrameHiddenBehindCorruptLength) {
+  ZnpFrameDecoder decoder;
+  // A SOF whose length byte claims more than the following frame holds
+  decoder.write(std::vector<uint8_t>({ SOF, 0x04 }));
+  decoder.write(PING_RESPONSE);
+
+  const auto frame = decoder.next();
+  ASSERT_TRUE(frame.has_value());
+  EXPECT_EQ(frame->command, SYS_PING);
+  EXPECT_EQ(decoder.statistics().checksum_failures, 1);
+}
+
+TEST(ZnpFrameDecoderTest, DropsOversizedLength) {
+  ZnpFrameDecoder decoder;
+  decoder.write(std::vector<uint8_t>({ SOF, 0xFF }));
+  decoder.write(RESET_INDICATION);
+
+  const auto frame = decoder.next();
+  ASSERT_TRUE(frame.has_value());
+  EXPECT_EQ(frame->command, SYS_RESET_IND);
+  EXPECT_EQ(decoder.statistics().length_failures, 1);
+  EXPECT_EQ(decoder.statistics().framesDropped(), 1);
+}
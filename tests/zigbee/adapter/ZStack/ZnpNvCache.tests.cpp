@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+
+#include "zigbee/adapter/ZStack/ZnpNvCache.hpp"
+
+using namespace lcl::zigbee::adapter::zstack;
+
+namespace {
+  ZnpNvCache::ReadResult readResult(const std::vector<uint8_t> &data) {
+    return ZnpNvCache::ReadResult::value({ { true }, data });
+  }
+}  // namespace
+
+TEST(ZnpNvCacheTest, WritesThroughAndInvalidates) {
+  ZnpNvCache cache(lcl::async::get_thread_pool());
+  EXPECT_FALSE(cache.contents(ZCD_NV_PAN_ID).has_value());
+
+  cache.storeContents(ZCD_NV_PAN_ID, { 0x62, 0x1A });
+  EXPECT_EQ(cache.length(ZCD_NV_PAN_ID), 2);
+  EXPECT_EQ(cache.contents(ZCD_NV_PAN_ID), std::vector<uint8_t>({ 0x62, 0x1A }));
+
+  cache.invalidate(ZCD_NV_PAN_ID);
+  EXPECT_FALSE(cache.length(ZCD_NV_PAN_ID).has_value());
+  EXPECT_EQ(cache.statistics().hits, 2);
+  EXPECT_EQ(cache.statistics().misses, 2);
+}
+
+TEST(ZnpNvCacheTest, OnlyCachesLengthsOfItemsTheStackRewrites) {
+  ZnpNvCache cache(lcl::async::get_thread_pool());
+  cache.storeContents(ZCD_NV_NIB, std::vector<uint8_t>(116));
+  EXPECT_EQ(cache.length(ZCD_NV_NIB), 116);
+  EXPECT_FALSE(cache.contents(ZCD_NV_NIB).has_value());
+
+  cache.storeContents(ZCD_NV_NWKKEY, std::vector<uint8_t>(24));
+  EXPECT_EQ(cache.length(ZCD_NV_NWKKEY), 24);
+  EXPECT_FALSE(cache.contents(ZCD_NV_NWKKEY).has_value());
+}
+
+TEST(ZnpNvCacheTest, CoalescesConcurrentReads) {
+  ZnpNvCache cache(lcl::async::get_thread_pool());
+  const auto leader = cache.beginRead(ZCD_NV_CHANLIST);
+  ASSERT_FALSE(leader.in_flight.has_value());
+
+  auto follower = cache.beginRead(ZCD_NV_CHANLIST);
+  ASSERT_TRUE(follower.in_flight.has_value());
+  auto joined = [&follower]() -> lcl::async::Task<ZnpNvCache::ReadResult> {
+    co_return co_await *follower.in_flight;
+  }();
+
+  cache.finishRead(ZCD_NV_CHANLIST, leader.generation, readResult({ 0x00, 0x08, 0x00, 0x00 }));
+  EXPECT_EQ(lcl::async::sync_wait(joined)->data, std::vector<uint8_t>({ 0x00, 0x08, 0x00, 0x00 }));
+  EXPECT_EQ(cache.contents(ZCD_NV_CHANLIST), std::vector<uint8_t>({ 0x00, 0x08, 0x00, 0x00 }));
+  EXPECT_EQ(cache.statistics().coalesced, 1);
+  EXPECT_FALSE(cache.beginRead(ZCD_NV_CHANLIST).in_flight.has_value());
+}
+
+TEST(ZnpNvCacheTest, DoesNotCacheReadsOverlappingAnInvalidation) {
+  ZnpNvCache cache(lcl::async::get_thread_pool());
+  const auto ticket = cache.beginRead(ZCD_NV_PAN_ID);
+  cache.invalidate(ZCD_NV_PAN_ID);
+  cache.finishRead(ZCD_NV_PAN_ID, ticket.generation, readResult({ 0xFF, 0xFF }));
+  EXPECT_FALSE(cache.contents(ZCD_NV_PAN_ID).has_value());
+}
+
+TEST(ZnpNvCacheTest, DoesNotCacheReadsOverlappingAWrite) {
+  ZnpNvCache cache(lcl::async::get_thread_pool());
+  // The write invalidates first, so the read starting mid-write carries the post-invalidation generation
+  cache.invalidate(ZCD_NV_PAN_ID);
+  const auto ticket = cache.beginRead(ZCD_NV_PAN_ID);
+  cache.storeContents(ZCD_NV_PAN_ID, { 0x62, 0x1A });
+  cache.finishRead(ZCD_NV_PAN_ID, ticket.generation, readResult({ 0x62, 0x00 }));
+  EXPECT_EQ(cache.contents(ZCD_NV_PAN_ID), std::vector<uint8_t>({ 0x62, 0x1A }));
+}
+
+TEST(ZnpNvCacheTest, AbandonedReadsFailTheirWaiters) {
+  ZnpNvCache cache(lcl::async::get_thread_pool());
+  const auto leader = cache.beginRead(ZCD_NV_PAN_ID);
+  auto follower = cache.beginRead(ZCD_NV_PAN_ID);
+  auto joined = [&follower]() -> lcl::async::Task<ZnpNvCache::ReadResult> {
+    co_return co_await *follower.in_flight;
+  }();
+
+  cache.abandonRead(ZCD_NV_PAN_ID, std::make_exception_ptr(std::runtime_error("timed out")));
+  EXPECT_THROW(lcl::async::sync_wait(joined), std::runtime_error);
+}
@@ -0,0 +1,50 @@
+#include <gtest/gtest.h>
+#include <sstream>
+
+#include "zigbee/adapter/ZStack/ZnpConstants.hpp"
+#include "zigbee/adapter/ZStack/ZnpNvSnapshot.hpp"
+
+using namespace lcl::zigbee::adapter::zstack;
+
+namespace {
+  ZnpNvSnapshot snapshot() {
+    ZnpNvSnapshot snapshot;
+    snapshot.product_id = ZNP_VERSION_ZSTACK_3x0;
+    snapshot.items[ZCD_NV_PAN_ID] = { 0x62, 0x1A };
+    snapshot.items[ZCD_NV_NIB] = std::vector<uint8_t>(116, 0x5A);
+    snapshot.items[ZCD_NV_PRECFGKEYS_ENABLE] = {};
+    return snapshot;
+  }
+
+  std::string serialized(const ZnpNvSnapshot &snapshot) {
+    std::ostringstream stream;
+    EXPECT_TRUE(snapshot.write(stream));
+    return stream.str();
+  }
+}  // namespace
+
+TEST(ZnpNvSnapshotTest, RoundTripsThroughAStream) {
+  std::istringstream stream(serialized(snapshot()));
+  const auto restored = ZnpNvSnapshot::read(stream);
+
+  ASSERT_TRUE(restored.has_value());
+  EXPECT_EQ(restored->product_id, ZNP_VERSION_ZSTACK_3x0);
+  EXPECT_EQ(restored->items, snapshot().items);
+}
+
+TEST(ZnpNvSnapshotTest, RejectsCorruptOrTruncatedSnapshots) {
+  auto bytes = serialized(snapshot());
+  bytes[20] ^= 0x01;
+  std::istringstream corrupt(bytes);
+  EXPECT_FALSE(ZnpNvSnapshot::read(corrupt).has_value());
+
+  std::istringstream truncated(serialized(snapshot()).substr(0, 30));
+  EXPECT_FALSE(ZnpNvSnapshot::read(truncated).has_value());
+}
+
+TEST(ZnpNvSnapshotTest, RejectsOtherFormatVersions) {
+  auto bytes = serialized(snapshot());
+  bytes[4] = ZnpNvSnapshot::FORMAT_VERSION + 1;
+  std::istringstream stream(bytes);
+  EXPECT_FALSE(ZnpNvSnapshot::read(stream).has_value());
+}
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <format>
+#include <set>
+#include <unordered_set>
+#include <vector>
+
+#include "zigbee/adapter/ZStack/ZnpTypes.hpp"
+
+using namespace lcl::zigbee::adapter::zstack;
+
+namespace {
+  RawZnpResponse srsp(const Subsystem subsystem, const MtCommandId command, std::vector<uint8_t> payload) {
+    return RawZnpResponse { command, subsystem, SRSP, std::move(payload) };
+  }
+}  // namespace
+
+TEST(ZnpTypesTest, DecodesPingCapabilitiesAsALittleEndianBitmask) {
+  const auto ping = SysPingResponse::parse(srsp(SUBSYSTEM_SYS, SYS_PING, { 0x59, 0x01 }));
+  ASSERT_TRUE(ping);
+  EXPECT_EQ(ping->capabilities, (ZnpCapabilities { MT_CAP_SYS, MT_CAP_AF, MT_CAP_ZDO, MT_CAP_UTIL, MT_CAP_APP }));
+  EXPECT_TRUE(ping->capabilities.has(MT_CAP_APP));
+  EXPECT_FALSE(ping->capabilities.has(MT_CAP_MAC));
+}
+
+TEST(ZnpTypesTest, AcceptsCreatingOrFindingAnNvItem) {
+  const auto created = SysOsalNvItemInitResponse::parse(srsp(SUBSYSTEM_SYS, SYS_OSAL_NV_ITEM_INIT, { 0x09 }));
+  ASSERT_TRUE(created);
+  EXPECT_EQ(created->status, SYS_OSAL_NV_ITEM_INIT_CREATED);
+  EXPECT_TRUE(created->succeeded());
+
+  const auto existing = SysOsalNvItemInitResponse::parse(srsp(SUBSYSTEM_SYS, SYS_OSAL_NV_ITEM_INIT, { 0x00 }));
+  ASSERT_TRUE(existing);
+  EXPECT_TRUE(existing->succeeded());
+
+  const auto failed = SysOsalNvItemInitResponse::parse(srsp(SUBSYSTEM_SYS, SYS_OSAL_NV_ITEM_INIT, { 0x0A }));
+  ASSERT_TRUE(failed);
+  EXPECT_FALSE(failed->succeeded());
+  EXPECT_FALSE(SysOsalNvItemInitResponse::parse(srsp(SUBSYSTEM_SYS, SYS_OSAL_NV_ITEM_INIT, {})));
+}
+
+TEST(ZnpTypesTest, RejectsTruncatedResponses) {
+  EXPECT_FALSE(SysPingResponse::parse(srsp(SUBSYSTEM_SYS, SYS_PING, { 0x59 })));
+  EXPECT_FALSE(SysVersionResponse::parse(srsp(SUBSYSTEM_SYS, SYS_VERSION, { 2, 1, 2, 7 })));
+  EXPECT_FALSE(SysOsalNvLengthResponse::parse(srsp(SUBSYSTEM_SYS, SYS_OSAL_NV_LENGTH, {})));
+  EXPECT_FALSE(StatusableResponse::parse(srsp(SUBSYSTEM_UTIL, UTIL_SET_PAN_ID, {})));
+  EXPECT_FALSE(GetDeviceInfoResponse::parse(srsp(SUBSYSTEM_UTIL, UTIL_GET_DEVICE_INFO, std::vector<uint8_t>(13))));
+}
+
+TEST(ZnpTypesTest, ListsOnlyTheAssociatedDevicesThatArrived) {
+  const auto info = GetDeviceInfoResponse::parse(srsp(SUBSYSTEM_UTIL, UTIL_GET_DEVICE_INFO, {
+    0x00,
+    0x8E, 0x3D, 0x4C, 0x21, 0x00, 0x4B, 0x12, 0x00,
+    0x00, 0x00,
+    0x07, 0x09,
+    0x03,
+    0x34, 0x12, 0x78, 0x56
+  }));
+
+  ASSERT_TRUE(info);
+  EXPECT_TRUE(info->status);
+  EXPECT_EQ(info->ieee_address, IEEEAddress(0x00124B00214C3D8E));
+  EXPECT_EQ(info->short_address, ShortAddress(0x0000));
+  EXPECT_EQ(info->device_state, static_cast<DeviceState>(0x09));
+  ASSERT_EQ(info->associatedDevices().size(), 2);
+  EXPECT_EQ(info->associatedDevices()[0], 0x1234);
+  EXPECT_EQ(info->associatedDevices()[1], 0x5678);
+}
+
+TEST(ZnpTypesTest, AddressesFormatOnlyWhenAsked) {
+  const IEEEAddress ieee_address { { 0x00, 0x12, 0x4B, 0x00, 0x21, 0x4C, 0x3D, 0x8E } };
+  EXPECT_EQ(ieee_address.value(), 0x00124B00214C3D8E);
+  EXPECT_EQ(ieee_address.toString(), "00124b00214c3d8e");
+  EXPECT_EQ(std::format("{}", ShortAddress(0x1A2B)), "1a2b");
+  EXPECT_EQ(ShortAddress({ 0x1A, 0x2B }), ShortAddress(0x1A2B));
+}
+
+TEST(ZnpTypesTest, AddressesKeyOrderedAndHashedContainers) {
+  const std::set ordered { IEEEAddress(2), IEEEAddress(1), IEEEAddress(2) };
+  EXPECT_EQ(ordered.size(), 2);
+  EXPECT_EQ(*ordered.begin(), IEEEAddress(1));
+
+  const std::unordered_set hashed { ShortAddress(0x0001), ShortAddress(0xFFFF), ShortAddress(0x0001) };
+  EXPECT_EQ(hashed.size(), 2);
+  EXPECT_TRUE(hashed.contains(ShortAddress(0xFFFF)));
+}